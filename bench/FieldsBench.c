@@ -0,0 +1,111 @@
+/** @file
+ * Microbenchmark comparing the vectorised splitting of command lines
+ * with the scalar fallback on a synthetic addRoad corpus.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "Fields.h"
+
+#define LINES 1000000
+#define ROUNDS 5
+
+static double seconds(clock_t start) {
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Returns the throughput of splitting all lines in MB/s */
+static double timeSplits(bool (*split)(Fields *, char *, size_t), const char *corpus, char *work,
+                         size_t size, const size_t *starts, uint64_t *fieldCount) {
+    Fields fields;
+    Fields_init(&fields);
+    double total = 0;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        // Splitting overwrites the semicolons, so every round gets a fresh copy
+        memcpy(work, corpus, size);
+        clock_t start = clock();
+
+        for (uint64_t i = 0; i < LINES; i++) {
+            split(&fields, work + starts[i], starts[i + 1] - starts[i] - 1);
+            *fieldCount += fields.valid ? fields.count : 0;
+        }
+
+        total += seconds(start);
+    }
+
+    Fields_free(&fields);
+
+    return (double) size * ROUNDS / total / 1e6;
+}
+
+/* Returns the throughput of checking the names of the cities in MB/s */
+static double timeNames(char (*names)[64], const size_t *lengths, uint64_t *validCount) {
+    uint64_t bytes = 0;
+    clock_t start = clock();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (uint64_t i = 0; i < LINES; i++) {
+            *validCount += Fields_isName(names[i], lengths[i]);
+            bytes += lengths[i];
+        }
+    }
+
+    return (double) bytes / seconds(start) / 1e6;
+}
+
+int main(void) {
+    static const char *prefixes[] = {"Warszawa", "Konstancin-Jeziorna", "Kędzierzyn-Koźle",
+                                     "Grodzisk Mazowiecki", "Ostrowiec Świętokrzyski", "Łódź"};
+    size_t capacity = (size_t) LINES * 128;
+    char *corpus = malloc(capacity);
+    char *work = malloc(capacity);
+    size_t *starts = malloc((LINES + 1) * sizeof(size_t));
+    char (*names)[64] = malloc(LINES * sizeof(*names));
+    size_t *lengths = malloc(LINES * sizeof(size_t));
+
+    if (corpus == NULL || work == NULL || starts == NULL || names == NULL || lengths == NULL)
+        return 1;
+
+    // Names of different lengths, so the tails of the vectors are exercised too
+    srand(2019);
+    size_t size = 0;
+    for (uint64_t i = 0; i < LINES; i++) {
+        const char *prefix1 = prefixes[rand() % 6];
+        const char *prefix2 = prefixes[rand() % 6];
+
+        starts[i] = size;
+        size += sprintf(corpus + size, "addRoad;%s %d;%s %d;%d;%d\n", prefix1, rand() % 10000,
+                        prefix2, rand() % 10000, 1 + rand() % 1000, 1900 + rand() % 120);
+        lengths[i] = sprintf(names[i], "%s %d", prefix1, rand() % 10000);
+    }
+    starts[LINES] = size;
+
+    uint64_t fieldCount = 0;
+    uint64_t validCount = 0;
+    double scalar = timeSplits(Fields_splitScalar, corpus, work, size, starts, &fieldCount);
+    double vector = timeSplits(Fields_split, corpus, work, size, starts, &fieldCount);
+    double checked = timeNames(names, lengths, &validCount);
+
+    printf("lines: %d, corpus: %.1f MB, rounds: %d, fields: %llu, names: %llu\n", LINES, size / 1e6, ROUNDS,
+           (unsigned long long) fieldCount, (unsigned long long) validCount);
+    printf("%-8s split %8.1f MB/s\n", "scalar", scalar);
+    printf("%-8s split %8.1f MB/s\n", "vector", vector);
+    printf("names    check %8.1f MB/s\n", checked);
+    printf("split speedup: %.2fx\n", vector / scalar);
+
+    free(corpus);
+    free(work);
+    free(starts);
+    free(names);
+    free(lengths);
+
+    return 0;
+}
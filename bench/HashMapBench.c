@@ -0,0 +1,204 @@
+/** @file
+ * Microbenchmark comparing name lookups in HashMap with the previous
+ * chained table.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "HashMap.h"
+#include "NameArena.h"
+
+#define NAMES 1000000
+#define ROUNDS 5
+
+/*
+ * Reference copy of the chained table HashMap used to be: separately
+ * allocated items, djb2 modulo the bucket count and strcmp on every item.
+ */
+typedef struct ChainedItem {
+    struct ChainedItem *next;
+    char *key;
+    void *value;
+} ChainedItem;
+
+typedef struct Chained {
+    ChainedItem **buckets;
+    uint64_t size;
+    uint64_t count;
+} Chained;
+
+static uint64_t chainedHash(const char *ptr, uint64_t size) {
+    uint64_t hash = 5381;
+    uint64_t c;
+
+    while ((c = *ptr++))
+        hash = ((hash << 5) + hash) + c;
+
+    return hash % size;
+}
+
+static void chainedRehash(Chained *hm) {
+    uint64_t size = 2 * hm->size;
+    ChainedItem **buckets = calloc(size, sizeof(ChainedItem *));
+
+    for (uint64_t i = 0; i < hm->size; i++) {
+        ChainedItem *next;
+        for (ChainedItem *item = hm->buckets[i]; item != NULL; item = next) {
+            uint64_t index = chainedHash(item->key, size);
+            next = item->next;
+            item->next = buckets[index];
+            buckets[index] = item;
+        }
+    }
+
+    free(hm->buckets);
+    hm->buckets = buckets;
+    hm->size = size;
+}
+
+static void chainedSet(Chained *hm, const char *key, void *value) {
+    uint64_t index = chainedHash(key, hm->size);
+    ChainedItem *item;
+
+    for (item = hm->buckets[index]; item != NULL; item = item->next) {
+        if (strcmp(key, item->key) == 0) {
+            item->value = value;
+            return;
+        }
+    }
+
+    item = malloc(sizeof(ChainedItem));
+
+    item->key = malloc(strlen(key) + 1);
+    strcpy(item->key, key);
+    item->value = value;
+    item->next = hm->buckets[index];
+    hm->buckets[index] = item;
+
+    if (++hm->count >= hm->size * 3 / 4)
+        chainedRehash(hm);
+}
+
+static void *chainedSearch(Chained *hm, const char *key) {
+    for (ChainedItem *item = hm->buckets[chainedHash(key, hm->size)]; item != NULL; item = item->next) {
+        if (strcmp(key, item->key) == 0)
+            return item->value;
+    }
+
+    return NULL;
+}
+
+static void chainedFree(Chained *hm) {
+    for (uint64_t i = 0; i < hm->size; i++) {
+        ChainedItem *next;
+        for (ChainedItem *item = hm->buckets[i]; item != NULL; item = next) {
+            next = item->next;
+            free(item->key);
+            free(item);
+        }
+    }
+
+    free(hm->buckets);
+}
+
+static double seconds(clock_t start) {
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void *hmapLookup(void *table, const char *key) {
+    return search_hmap((hmap *) table, (char *) key);
+}
+
+static void *chainedLookup(void *table, const char *key) {
+    return chainedSearch((Chained *) table, key);
+}
+
+/* Returns the average time of one lookup in nanoseconds */
+static double timeLookups(void *(*lookup)(void *, const char *), void *table,
+                          char (*keys)[16], uint64_t *found) {
+    clock_t start = clock();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (uint64_t i = 0; i < NAMES; i++)
+            *found += lookup(table, keys[i]) != NULL;
+    }
+
+    return seconds(start) / ((double) ROUNDS * NAMES) * 1e9;
+}
+
+int main(void) {
+    char (*names)[16] = malloc(NAMES * sizeof(*names));
+    char (*hits)[16] = malloc(NAMES * sizeof(*hits));
+    char (*missing)[16] = malloc(NAMES * sizeof(*missing));
+    uint64_t *order = malloc(NAMES * sizeof(uint64_t));
+
+    if (names == NULL || hits == NULL || missing == NULL || order == NULL)
+        return 1;
+
+    for (uint64_t i = 0; i < NAMES; i++) {
+        sprintf(names[i], "City%llu", (unsigned long long) i);
+        order[i] = i;
+    }
+
+    // Shuffle the lookup order, so lookups do not follow insertion order
+    srand(2019);
+    for (uint64_t i = NAMES - 1; i > 0; i--) {
+        uint64_t j = ((uint64_t) rand() * RAND_MAX + rand()) % (i + 1);
+        uint64_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    // Queries are read sequentially, like names coming from parsed commands
+    for (uint64_t i = 0; i < NAMES; i++) {
+        strcpy(hits[i], names[order[i]]);
+        sprintf(missing[i], "Town%llu", (unsigned long long) order[i]);
+    }
+
+    NameArena *arena = NameArena_create();
+    hmap *hm = create_hmap(1000);
+    Chained chained = {calloc(1000, sizeof(ChainedItem *)), 1000, 0};
+
+    clock_t start = clock();
+    for (uint64_t i = 0; i < NAMES; i++) {
+        uint64_t length = strlen(names[i]);
+        Name *name = NameArena_store(arena, names[i], length, Name_hash(names[i], length));
+        set_hmap(hm, name, names[i]);
+    }
+    double hmapInsert = seconds(start);
+
+    start = clock();
+    for (uint64_t i = 0; i < NAMES; i++)
+        chainedSet(&chained, names[i], names[i]);
+    double chainedInsert = seconds(start);
+
+    uint64_t found = 0;
+    double hmapHit = timeLookups(hmapLookup, hm, hits, &found);
+    double hmapMiss = timeLookups(hmapLookup, hm, missing, &found);
+    double chainedHit = timeLookups(chainedLookup, &chained, hits, &found);
+    double chainedMiss = timeLookups(chainedLookup, &chained, missing, &found);
+
+    printf("names: %d, lookups per column: %d, found: %llu\n",
+           NAMES, ROUNDS * NAMES, (unsigned long long) found);
+    printf("%-8s insert %6.3f s   hit %6.1f ns/op   miss %6.1f ns/op\n",
+           "chained", chainedInsert, chainedHit, chainedMiss);
+    printf("%-8s insert %6.3f s   hit %6.1f ns/op   miss %6.1f ns/op\n",
+           "hmap", hmapInsert, hmapHit, hmapMiss);
+    printf("lookup speedup: hit %.2fx, miss %.2fx\n", chainedHit / hmapHit, chainedMiss / hmapMiss);
+
+    chainedFree(&chained);
+    free_hmap(hm);
+    NameArena_free(arena);
+    free(names);
+    free(hits);
+    free(missing);
+    free(order);
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/** @file
+ * Benchmark comparing the priority queues of the searches on grid and
+ * random maps.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "map.h"
+
+#define GRID_SIDE 400
+#define RANDOM_CITIES 160000
+#define RANDOM_DEGREE 3
+#define SEARCHES 20
+
+static unsigned long long state = 2019;
+
+static unsigned nextRandom(void) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned) (state >> 33);
+}
+
+static void cityName(char *buffer, unsigned id) {
+    sprintf(buffer, "City%u", id);
+}
+
+static Map *gridMap(unsigned side, unsigned maxLength) {
+    Map *map = newMap();
+    char a[32], b[32];
+
+    for (unsigned i = 0; i < side; i++) {
+        for (unsigned j = 0; j < side; j++) {
+            cityName(a, i * side + j);
+
+            if (i + 1 < side) {
+                cityName(b, (i + 1) * side + j);
+                addRoad(map, a, b, 1 + nextRandom() % maxLength, 1950 + (int) (nextRandom() % 70));
+            }
+
+            if (j + 1 < side) {
+                cityName(b, i * side + j + 1);
+                addRoad(map, a, b, 1 + nextRandom() % maxLength, 1950 + (int) (nextRandom() % 70));
+            }
+        }
+    }
+
+    return map;
+}
+
+static Map *randomMap(unsigned cities, unsigned degree, unsigned maxLength) {
+    Map *map = newMap();
+    char a[32], b[32];
+
+    // A path through all cities keeps the map connected
+    for (unsigned i = 0; i + 1 < cities; i++) {
+        cityName(a, i);
+        cityName(b, i + 1);
+        addRoad(map, a, b, 1 + nextRandom() % maxLength, 1950 + (int) (nextRandom() % 70));
+    }
+
+    for (unsigned i = 0; i < cities * (degree - 1) / 2; i++) {
+        cityName(a, nextRandom() % cities);
+        cityName(b, nextRandom() % cities);
+        addRoad(map, a, b, 1 + nextRandom() % maxLength, 1950 + (int) (nextRandom() % 70));
+    }
+
+    return map;
+}
+
+/* Runs a full single source search, the same relaxation as dijkstra() */
+static uint64_t search(Map *map, uint64_t src) {
+    CsrGraph *graph = map->graph;
+    SearchWorkspace *ws = map->workspace;
+    uint64_t checksum = 0;
+    uint64_t u;
+
+    SearchWorkspace_begin(ws, map->nCities);
+    SearchWorkspace_relax(ws, src, 0, 0, INT32_MAX, NULL);
+
+    while ((u = SearchWorkspace_extractMin(ws)) != UINT64_MAX) {
+        uint64_t distU = ws->dist[u];
+        int yearU = ws->years[u];
+        checksum += distU + (uint64_t) yearU;
+
+        for (uint64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            uint64_t v = graph->targets[e];
+
+            if (SearchWorkspace_isSettled(ws, v))
+                continue;
+
+            uint64_t distV = distU + graph->lengths[e];
+            int yearV = graph->years[e] < yearU ? graph->years[e] : yearU;
+            uint64_t currentDist = SearchWorkspace_dist(ws, v);
+
+            if (distV < currentDist || (distV == currentDist && yearV > SearchWorkspace_year(ws, v)))
+                SearchWorkspace_relax(ws, v, distV, distV, yearV, map->cities[u]);
+        }
+    }
+
+    return checksum;
+}
+
+static void compare(const char *name, Map *map) {
+    const char *queues[] = {"heap", "radix"};
+    double times[2];
+    uint64_t checksums[2];
+
+    CsrGraph_rebuild(map->graph, map->cities, map->nCities);
+
+    for (int q = 0; q < 2; q++) {
+        SearchWorkspace_setQueue(map->workspace, q == 0 ? QUEUE_HEAP : QUEUE_RADIX);
+        state = 7;
+        checksums[q] = 0;
+
+        clock_t start = clock();
+        for (int i = 0; i < SEARCHES; i++)
+            checksums[q] += search(map, nextRandom() % map->nCities);
+        times[q] = (double) (clock() - start) / CLOCKS_PER_SEC / SEARCHES * 1e3;
+    }
+
+    printf("%-22s cities %7llu", name, (unsigned long long) map->nCities);
+    for (int q = 0; q < 2; q++)
+        printf("   %s %8.2f ms", queues[q], times[q]);
+    printf("   speedup %.2fx%s\n", times[0] / times[1], checksums[0] == checksums[1] ? "" : "   CHECKSUM MISMATCH");
+}
+
+int main(void) {
+    Map *map = gridMap(GRID_SIDE, 10);
+    compare("grid, lengths 1-10", map);
+    deleteMap(map);
+
+    map = gridMap(GRID_SIDE, 1000000);
+    compare("grid, lengths 1-1e6", map);
+    deleteMap(map);
+
+    map = randomMap(RANDOM_CITIES, RANDOM_DEGREE, 10);
+    compare("random, lengths 1-10", map);
+    deleteMap(map);
+
+    map = randomMap(RANDOM_CITIES, RANDOM_DEGREE, 1000000);
+    compare("random, lengths 1-1e6", map);
+    deleteMap(map);
+
+    return 0;
+}
@@ -2,9 +2,26 @@
 #include <stdbool.h>
 #include <string.h>
 #include "CityRoad.h"
+#include "EdgeIndex.h"
+#include "RouteCities.h"
+#include "LineWriter.h"
 
-List *List_create(void) {
-    List *list = (List *) malloc(sizeof(List));
+void ObjectPools_init(ObjectPools *pools) {
+    Pool_init(&pools->cities, sizeof(City));
+    Pool_init(&pools->roads, sizeof(Road));
+    Pool_init(&pools->lists, sizeof(List));
+    Pool_init(&pools->routeUses, sizeof(RouteUse));
+}
+
+void ObjectPools_destroy(ObjectPools *pools) {
+    Pool_destroy(&pools->cities);
+    Pool_destroy(&pools->roads);
+    Pool_destroy(&pools->lists);
+    Pool_destroy(&pools->routeUses);
+}
+
+List *List_create(ObjectPools *pools) {
+    List *list = (List *) Pool_alloc(&pools->lists);
     if (list == NULL)
         return NULL;
 
@@ -14,85 +31,456 @@ List *List_create(void) {
     return list;
 }
 
-Road *Road_create(City *adjCity, unsigned length, int builtYear) {
-    Road *road = (Road *) malloc(sizeof(Road));
+Road *Road_create(ObjectPools *pools, City *adjCity, unsigned length, int builtYear) {
+    Road *road = (Road *) Pool_alloc(&pools->roads);
 
     if (road == NULL)
         return NULL;
 
     road->adjCity = adjCity;
-
-    if (adjCity != NULL)
-        adjCity->visited = false;
-
     road->length = length;
     road->builtYear = builtYear;
     road->nextRoadOfCity = NULL;
+    road->routeUses = NULL;
 
     return road;
 }
 
-City *City_create(const char *cityName, uint64_t id) {
-    City *city = (City *) malloc(sizeof(City));
+City *City_create(ObjectPools *pools, Name *cityName, uint64_t id) {
+    City *city = (City *) Pool_alloc(&pools->cities);
 
     if (city == NULL)
         return NULL; /* In case when allocation failed */
 
-    char *str_new = (char *) malloc(sizeof(char) * (strlen(cityName) + 1));
+    city->cityName = cityName;
+    city->id = id;
+    city->roadsList = List_create(pools);
 
-    if (str_new == NULL)
+    if (city->roadsList == NULL) {
+        Pool_release(&pools->cities, city);
         return NULL;
-
-    strcpy(str_new, cityName);
-    city->cityName = str_new;
-    city->visited = false;
-    city->id = id;
-    city->roadsList = List_create();
+    }
 
     return city;
 }
 
-Route *Route_create(void) {
+Route *Route_create(uint64_t capacity) {
     Route *route = (Route *) malloc(sizeof(Route));
 
     if (route == NULL)
         return NULL;
 
-    route->routeNodeList = List_create();
+    if (capacity == 0)
+        capacity = 1;
+
+    route->cities = (City **) malloc(capacity * sizeof(City *));
+    route->lengths = (unsigned *) malloc(capacity * sizeof(unsigned));
+    route->years = (int *) malloc(capacity * sizeof(int));
+
+    if (route->cities == NULL || route->lengths == NULL || route->years == NULL) {
+        free(route->cities);
+        free(route->lengths);
+        free(route->years);
+        free(route);
+        return NULL;
+    }
+
+    route->first = 0;
+    route->count = 0;
+    route->capacity = capacity;
+    route->length = 0;
+    route->oldestYear = INT32_MAX;
+    route->oldestValid = true;
+    route->index = NULL;
+    route->description = NULL;
+    route->descriptionLength = 0;
 
     return route;
 }
 
-RouteNode *RouteNode_create(City *city, unsigned length, int age) {
-    RouteNode *routeNode = (RouteNode *) malloc(sizeof(RouteNode));
+void Route_free(Route *route) {
+    if (route == NULL)
+        return;
+
+    free(route->cities);
+    free(route->lengths);
+    free(route->years);
+    free(route->description);
+    RouteCities_free(route->index);
+    free(route);
+}
+
+/* Stores the positions of the cities at indices from .. from + count - 1 */
+static void updatePositions(Route *route, uint64_t from, uint64_t count) {
+    if (route->index == NULL)
+        return;
 
-    if (routeNode == NULL)
-        return NULL;
+    // Replacing the position of a city cannot fail
+    for (uint64_t i = from; i < from + count; i++)
+        RouteCities_insert(route->index, route->cities[i]->id, i);
+}
+
+/* Moves count cities together with the roads leaving them from index from to index to */
+static void moveCities(Route *route, uint64_t from, uint64_t to, uint64_t count) {
+    memmove(route->cities + to, route->cities + from, count * sizeof(City *));
+    memmove(route->lengths + to, route->lengths + from, count * sizeof(unsigned));
+    memmove(route->years + to, route->years + from, count * sizeof(int));
+    updatePositions(route, to, count);
+}
+
+/* Moves the route into larger arrays with the gap before index at, leaving
+ * as much free room before the route as after it */
+static bool regrow(Route *route, uint64_t at, uint64_t gap, uint64_t *start) {
+    uint64_t count = route->count + gap;
+    uint64_t capacity = 2 * count;
+    City **cities = (City **) malloc(capacity * sizeof(City *));
+    unsigned *lengths = (unsigned *) malloc(capacity * sizeof(unsigned));
+    int *years = (int *) malloc(capacity * sizeof(int));
 
-    routeNode->city = city;
+    if (cities == NULL || lengths == NULL || years == NULL) {
+        free(cities);
+        free(lengths);
+        free(years);
+        return false;
+    }
+
+    uint64_t first = (capacity - count) / 2;
+    uint64_t prefix = at - route->first;
+    uint64_t suffix = route->count - prefix;
 
-    if (city != NULL)
-        routeNode->city->visited = false;
+    memcpy(cities + first, route->cities + route->first, prefix * sizeof(City *));
+    memcpy(lengths + first, route->lengths + route->first, prefix * sizeof(unsigned));
+    memcpy(years + first, route->years + route->first, prefix * sizeof(int));
+    memcpy(cities + first + prefix + gap, route->cities + at, suffix * sizeof(City *));
+    memcpy(lengths + first + prefix + gap, route->lengths + at, suffix * sizeof(unsigned));
+    memcpy(years + first + prefix + gap, route->years + at, suffix * sizeof(int));
 
-    routeNode->length = length;
-    routeNode->age = age;
-    routeNode->next = NULL;
+    free(route->cities);
+    free(route->lengths);
+    free(route->years);
+    route->cities = cities;
+    route->lengths = lengths;
+    route->years = years;
+    route->first = first;
+    route->capacity = capacity;
 
-    return routeNode;
+    updatePositions(route, first, prefix);
+    updatePositions(route, first + prefix + gap, suffix);
+    *start = first + prefix;
+
+    return true;
 }
 
-Road *areConnected(City *city1, City *city2) {
-    if (city1 == NULL || city2 == NULL)
+/* Makes room for gap cities before index at, moving the shorter part of the route,
+ * and saves in start the index of the first free place */
+static bool openGap(Route *route, uint64_t at, uint64_t gap, uint64_t *start) {
+    uint64_t end = route->first + route->count;
+    uint64_t prefix = at - route->first;
+    uint64_t suffix = end - at;
+    bool roomBefore = route->first >= gap;
+    bool roomAfter = route->capacity - end >= gap;
+
+    if (roomBefore && (prefix <= suffix || !roomAfter)) {
+        moveCities(route, route->first, route->first - gap, prefix);
+        route->first -= gap;
+        *start = at - gap;
+    } else if (roomAfter) {
+        moveCities(route, at, at + gap, suffix);
+        *start = at;
+    } else if (!regrow(route, at, gap, start)) {
+        return false;
+    }
+
+    route->count += gap;
+
+    return true;
+}
+
+/* Drops the description, as the route has changed */
+static inline void forgetDescription(Route *route) {
+    free(route->description);
+    route->description = NULL;
+}
+
+/* Counts a new road of the route in its oldest year */
+static inline void addYear(Route *route, int year) {
+    if (year < route->oldestYear)
+        route->oldestYear = year;
+}
+
+/* Forgets a road of the route leaving it, the oldest year is recomputed if it was that one */
+static inline void removeYear(Route *route, int year) {
+    if (year == route->oldestYear)
+        route->oldestValid = false;
+}
+
+/* Indexes the cities path->cities[from] .. path->cities[to - 1], they get their
+ * positions when they are copied into the route */
+static bool indexCities(Route *route, const Route *path, uint64_t from, uint64_t to) {
+    if (route->index == NULL)
+        return true;
+
+    for (uint64_t i = from; i < to; i++) {
+        if (!RouteCities_insert(route->index, path->cities[i]->id, ROUTE_NO_POSITION - 1)) {
+            while (i-- > from)
+                RouteCities_remove(route->index, path->cities[i]->id);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void unindexCities(Route *route, const Route *path, uint64_t from, uint64_t to) {
+    if (route->index == NULL)
+        return;
+
+    for (uint64_t i = from; i < to; i++)
+        RouteCities_remove(route->index, path->cities[i]->id);
+}
+
+/* Copies count roads of the path starting at index from, with the cities they lead to,
+ * behind the city at index at of the route. A city the path ends at may already be there. */
+static void copyPath(Route *route, uint64_t at, const Route *path, uint64_t from, uint64_t count) {
+    for (uint64_t i = 0; i < count; i++) {
+        route->lengths[at + i] = path->lengths[from + i];
+        route->years[at + i] = path->years[from + i];
+        addYear(route, path->years[from + i]);
+    }
+
+    memcpy(route->cities + at + 1, path->cities + from + 1, count * sizeof(City *));
+    updatePositions(route, at + 1, count);
+}
+
+bool Route_append(Route *route, City *city, unsigned length, int year) {
+    if (route->index != NULL && !RouteCities_insert(route->index, city->id, ROUTE_NO_POSITION - 1))
+        return false;
+
+    uint64_t at;
+    if (!openGap(route, route->first + route->count, 1, &at)) {
+        if (route->index != NULL)
+            RouteCities_remove(route->index, city->id);
+
+        return false;
+    }
+
+    route->cities[at] = city;
+    updatePositions(route, at, 1);
+    forgetDescription(route);
+
+    if (route->count > 1) {
+        route->lengths[at - 1] = length;
+        route->years[at - 1] = year;
+        route->length += length;
+        addYear(route, year);
+    }
+
+    return true;
+}
+
+bool Route_appendRoute(Route *route, const Route *extension) {
+    uint64_t roads = extension->count - 1;
+    uint64_t from = extension->first;
+    uint64_t start;
+
+    if (!indexCities(route, extension, from + 1, from + extension->count))
+        return false;
+
+    if (!openGap(route, route->first + route->count, roads, &start)) {
+        unindexCities(route, extension, from + 1, from + extension->count);
+        return false;
+    }
+
+    // The first city of the extension is already the last one of the route
+    copyPath(route, start - 1, extension, from, roads);
+    route->length += extension->length;
+    forgetDescription(route);
+
+    return true;
+}
+
+bool Route_prependRoute(Route *route, const Route *extension) {
+    uint64_t roads = extension->count - 1;
+    uint64_t from = extension->first;
+    uint64_t start;
+
+    if (!indexCities(route, extension, from, from + roads))
+        return false;
+
+    if (!openGap(route, route->first, roads, &start)) {
+        unindexCities(route, extension, from, from + roads);
+        return false;
+    }
+
+    // The last city of the extension is already the first one of the route
+    route->cities[start] = extension->cities[from];
+    updatePositions(route, start, 1);
+    copyPath(route, start, extension, from, roads);
+    route->length += extension->length;
+    forgetDescription(route);
+
+    return true;
+}
+
+bool Route_reserve(Route *route, const Route *path) {
+    uint64_t gap = path->count;
+    uint64_t end = route->first + route->count;
+    uint64_t start;
+
+    if (route->index != NULL) {
+        uint64_t maxId = 0;
+
+        for (uint64_t i = path->first; i < path->first + path->count; i++) {
+            if (path->cities[i]->id > maxId)
+                maxId = path->cities[i]->id;
+        }
+
+        if (!RouteCities_reserve(route->index, gap, maxId))
+            return false;
+    }
+
+    // A gap opens without allocation when either end of the arrays has room for it
+    if (route->first >= gap || route->capacity - end >= gap)
+        return true;
+
+    return regrow(route, end, gap, &start);
+}
+
+bool Route_splice(Route *route, uint64_t position, const Route *detour) {
+    uint64_t from = detour->first;
+    uint64_t newCities = detour->count - 2;
+    unsigned removedLength = route->lengths[position];
+    int removedYear = route->years[position];
+    uint64_t start;
+
+    if (!indexCities(route, detour, from + 1, from + 1 + newCities))
+        return false;
+
+    if (!openGap(route, position + 1, newCities, &start)) {
+        unindexCities(route, detour, from + 1, from + 1 + newCities);
+        return false;
+    }
+
+    // Both ends of the detour are already on the route, around the gap
+    copyPath(route, start - 1, detour, from, newCities + 1);
+    route->length = route->length - removedLength + detour->length;
+    removeYear(route, removedYear);
+    forgetDescription(route);
+
+    return true;
+}
+
+void Route_setYear(Route *route, uint64_t position, int year) {
+    removeYear(route, route->years[position]);
+    route->years[position] = year;
+    addYear(route, year);
+    forgetDescription(route);
+}
+
+/* Writes the number at the given place, giving the place behind it */
+static inline char *putNumber(char *at, int64_t value) {
+    return at + LineWriter_formatNumber(at, value);
+}
+
+/* Writes the separator and the name of the city at the given place, giving the place behind them */
+static inline char *putCity(char *at, const City *city) {
+    *at++ = ';';
+    memcpy(at, city->cityName->chars, city->cityName->length);
+
+    return at + city->cityName->length;
+}
+
+const char *Route_description(Route *route, unsigned routeId, size_t *length) {
+    if (route->description != NULL) {
+        *length = route->descriptionLength;
+        return route->description;
+    }
+
+    uint64_t last = route->first + route->count - 1;
+    size_t size = LineWriter_numberLength(routeId);
+
+    // The exact size comes from the lengths of the names and of the numbers
+    for (uint64_t i = route->first; i <= last; i++)
+        size += 1 + route->cities[i]->cityName->length;
+
+    for (uint64_t i = route->first; i < last; i++)
+        size += 2 + LineWriter_numberLength(route->lengths[i]) + LineWriter_numberLength(route->years[i]);
+
+    char *description = (char *) malloc(size + 1);
+
+    if (description == NULL)
         return NULL;
 
-    Road *currentRoad = city1->roadsList->head;
+    char *at = putNumber(description, routeId);
 
-    while (currentRoad != NULL) {
-        if (currentRoad->adjCity == city2)
-            return currentRoad;
+    for (uint64_t i = route->first; i < last; i++) {
+        at = putCity(at, route->cities[i]);
+        *at++ = ';';
+        at = putNumber(at, route->lengths[i]);
+        *at++ = ';';
+        at = putNumber(at, route->years[i]);
+    }
+
+    at = putCity(at, route->cities[last]);
+    *at = '\0';
+
+    route->description = description;
+    route->descriptionLength = size;
+    *length = size;
+
+    return description;
+}
+
+int Route_oldestYear(Route *route) {
+    if (!route->oldestValid) {
+        route->oldestYear = INT32_MAX;
 
-        currentRoad = currentRoad->nextRoadOfCity;
+        for (uint64_t i = route->first; i + 1 < route->first + route->count; i++)
+            addYear(route, route->years[i]);
+
+        route->oldestValid = true;
     }
 
-    return NULL;
+    return route->oldestYear;
+}
+
+bool RouteUse_add(ObjectPools *pools, Road *road, unsigned routeId, City *from) {
+    RouteUse *use = (RouteUse *) Pool_alloc(&pools->routeUses);
+
+    if (use == NULL)
+        return false;
+
+    RouteUse **link = &road->routeUses;
+
+    while (*link != NULL && (*link)->routeId < routeId)
+        link = &(*link)->next;
+
+    use->routeId = routeId;
+    use->from = from;
+    use->next = *link;
+    *link = use;
+
+    return true;
+}
+
+void RouteUse_remove(ObjectPools *pools, Road *road, unsigned routeId) {
+    RouteUse **link = &road->routeUses;
+
+    while (*link != NULL && (*link)->routeId != routeId)
+        link = &(*link)->next;
+
+    if (*link == NULL)
+        return;
+
+    RouteUse *use = *link;
+    *link = use->next;
+    Pool_release(&pools->routeUses, use);
+}
+
+Road *areConnected(EdgeIndex *roads, City *city1, City *city2) {
+    if (city1 == NULL || city2 == NULL)
+        return NULL;
+
+    return EdgeIndex_find(roads, city1->id, city2->id);
 }
\ No newline at end of file
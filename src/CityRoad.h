@@ -11,6 +11,9 @@
 #define GRAPHS_CITYROAD_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include "Pool.h"
+#include "NameArena.h"
 
 /**
  * Structure storing a city with edges to
@@ -29,15 +32,36 @@ typedef struct Road Road;
 typedef struct Route Route;
 
 /**
- * Structure storing a routNode.
+ * Structure storing the positions of the cities of one route keyed by city ids.
  */
-typedef struct RouteNode RouteNode;
+typedef struct RouteCities RouteCities;
+
+/**
+ * Structure storing a national route going along a road.
+ */
+typedef struct RouteUse RouteUse;
 
 /**
  * Structure storing a linked list for intermediary uses.
  */
 typedef struct LinkedList List;
 
+/**
+ * Structure storing a hash index of roads keyed by pairs of city ids.
+ */
+typedef struct EdgeIndex EdgeIndex;
+
+/**
+ * @brief Structure storing the pools the cities, roads, lists and route uses
+ * of one map are allocated from.
+ */
+typedef struct ObjectPools {
+    Pool cities; /**< Pool of the City structures. */
+    Pool roads; /**< Pool of the Road structures. */
+    Pool lists; /**< Pool of the List structures. */
+    Pool routeUses; /**< Pool of the RouteUse structures. */
+} ObjectPools;
+
 struct LinkedList {
     void *head; /**< Head of the linked list. */
     void *tail; /**< Tail keeps the reference on the last node of the list. */
@@ -48,76 +72,217 @@ struct Road {
     unsigned length; /**< Length of the road. */
     int builtYear; /**< Built year or the year of the last repair of the road. */
     Road *nextRoadOfCity; /**< Keeps reference on the next Road. */
+    RouteUse *routeUses; /**< Routes going along the road, kept only on the road from the city with the smaller id. */
 };
 
 struct City {
-    char *cityName; /**< Name of the city. */
+    Name *cityName; /**< Interned name of the city, shared with the HashMap. */
     uint64_t id; /**< Id of the city, to be used in dijkstra algorithm. */
-    bool visited; /**< Whether city is visited, to be used in dijkstra algorithm. */
     List *roadsList; /**< List of the roads to adjacent cities. */
 };
 
+/**
+ * The cities of a route are stored contiguously in parallel arrays, with free
+ * room kept at both ends, so extending the route at either end moves nothing
+ * and a detour moves only the shorter part of the route around it.
+ */
 struct Route {
-    List *routeNodeList; /**< List of the RouteNodes. */
+    City **cities; /**< Cities of the route are cities[first] .. cities[first + count - 1]. */
+    unsigned *lengths; /**< lengths[i] is the length of the road from cities[i] to cities[i + 1]. */
+    int *years; /**< years[i] is the built year of the road from cities[i] to cities[i + 1]. */
+    uint64_t first; /**< Index of the first city of the route in the arrays. */
+    uint64_t count; /**< Number of cities of the route. */
+    uint64_t capacity; /**< Size of the arrays. */
+    uint64_t length; /**< Sum of the lengths of the roads of the route. */
+    int oldestYear; /**< Oldest year of the roads, INT32_MAX for a route without roads. */
+    bool oldestValid; /**< Whether oldestYear is up to date, it is recomputed only when asked for. */
+    RouteCities *index; /**< Position of every city of the route, NULL until the route is stored on the map. */
+    char *description; /**< Description of the route given last, NULL if the route has changed since. */
+    size_t descriptionLength; /**< Number of characters of the description. */
 };
 
-struct RouteNode {
-    City *city; /**< Reference on a city in the route. */
-    unsigned length; /**< Length of a road between two cities in a route. */
-    int age; /**< Built year of a road between two cities in a route. */
-    struct RouteNode *next; /**< Reference on the next RouteNode in the route. */
+struct RouteUse {
+    unsigned routeId; /**< Id of the route going along the road. */
+    City *from; /**< City of the route the road leaves from towards the next city of the route. */
+    RouteUse *next; /**< Next route going along the road, in the increasing order of ids. */
 };
 
+/**
+ * @brief Initialises empty pools for the objects of one map.
+ * @param[out] pools - pointer on the pools.
+ */
+void ObjectPools_init(ObjectPools *pools);
+
+/**
+ * @brief Frees all objects allocated from the pools at once.
+ * @param[in, out] pools - pointer on the pools.
+ */
+void ObjectPools_destroy(ObjectPools *pools);
+
 /**
  * @brief Creates a linked list.
  * The list type may be any specified structure. To be used to keep the head and tail of
  * any list to prevent each time finding the last node of the list.
+ * @param[in, out] pools - pools to allocate from.
  * @return a pointer on a created linked list, or NULL if allocation failed.
  */
-List *List_create(void);
+List *List_create(ObjectPools *pools);
 
 /**
  * @brief Creates road to adjacent city.
+ * @param[in, out] pools - pools to allocate from;
  * @param[in] adjCity   - pointer to adjacent city;
  * @param[in] length    - length of the road to adjacent city;
  * @param[in] builtYear - built year or the year of the last repair of the road.
  * @return pointer on the created road, or NULL if memory allocation failed.
  */
-Road *Road_create(City *adjCity, unsigned length, int builtYear);
+Road *Road_create(ObjectPools *pools, City *adjCity, unsigned length, int builtYear);
 
 /**
  * @brief Creates a city with a given name without any roads.
- * @param[in] cityName - name of the city to be created;
+ * @param[in, out] pools - pools to allocate from;
+ * @param[in] cityName - interned name of the city to be created;
  * @param[in] id       - id of the city.
  * @return pointer on the created city, or NULL if memory allocation failed.
  */
-City *City_create(const char *cityName, uint64_t id);
+City *City_create(ObjectPools *pools, Name *cityName, uint64_t id);
 
 /**
- * @brief Creates new route.
- * Route has a linked list of RouteNodes.
+ * @brief Creates new route without any cities.
+ * @param[in] capacity - number of cities the route has room for.
  * @return pointer on a created route, or NULL if memory allocation failed.
  */
-Route *Route_create(void);
+Route *Route_create(uint64_t capacity);
+
+/**
+ * @brief Frees the route together with the index of its cities.
+ * Does nothing if the route is NULL.
+ * @param[in] route - pointer on the route.
+ */
+void Route_free(Route *route);
+
+/**
+ * @brief Gives the first city of the route.
+ * @param[in] route - pointer on a route with at least one city.
+ * @return pointer on the first city.
+ */
+static inline City *Route_head(const Route *route) {
+    return route->cities[route->first];
+}
+
+/**
+ * @brief Gives the last city of the route.
+ * @param[in] route - pointer on a route with at least one city.
+ * @return pointer on the last city.
+ */
+static inline City *Route_tail(const Route *route) {
+    return route->cities[route->first + route->count - 1];
+}
+
+/**
+ * @brief Appends a city at the end of the route.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] city       - pointer on the city, not on the route yet;
+ * @param[in] length     - length of the road from the last city, ignored for the first city;
+ * @param[in] year       - built year of the road from the last city, ignored for the first city.
+ * @return @p true on success, @p false if memory allocation failed, then the route is unchanged.
+ */
+bool Route_append(Route *route, City *city, unsigned length, int year);
+
+/**
+ * @brief Extends the route beyond its last city.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] extension  - pointer on a route starting at the last city of the route,
+ *                         with no other city on the route.
+ * @return @p true on success, @p false if memory allocation failed, then the route is unchanged.
+ */
+bool Route_appendRoute(Route *route, const Route *extension);
+
+/**
+ * @brief Extends the route before its first city.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] extension  - pointer on a route ending at the first city of the route,
+ *                         with no other city on the route.
+ * @return @p true on success, @p false if memory allocation failed, then the route is unchanged.
+ */
+bool Route_prependRoute(Route *route, const Route *extension);
+
+/**
+ * @brief Makes room for the cities of a path, so splicing it into the route cannot fail.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] path       - pointer on a route whose inner cities are to be inserted.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool Route_reserve(Route *route, const Route *path);
+
+/**
+ * @brief Replaces a road of the route with a detour.
+ * Cities of the route after the road or before it, whichever are fewer, are moved.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] position   - index of the city the replaced road leaves from;
+ * @param[in] detour     - pointer on a route between both ends of the road with
+ *                         no other city on the route.
+ * @return @p true on success, @p false if memory allocation failed, then the route is unchanged.
+ */
+bool Route_splice(Route *route, uint64_t position, const Route *detour);
+
+/**
+ * @brief Sets the year of a road of the route after it was repaired.
+ * @param[in, out] route - pointer on the route;
+ * @param[in] position   - index of the city the road leaves from;
+ * @param[in] year       - year of the repair, not older than the current one.
+ */
+void Route_setYear(Route *route, uint64_t position, int year);
+
+/**
+ * @brief Gives the description of the route under the given number.
+ * The description is built once and kept until the route changes, which
+ * includes a repair of one of its roads. A route is described only under
+ * the one number it is stored with.
+ * @param[in, out] route - pointer on a route with at least one city;
+ * @param[in] routeId    - number of the route;
+ * @param[out] length    - number of characters of the description.
+ * @return the description owned by the route, or NULL if memory allocation failed.
+ */
+const char *Route_description(Route *route, unsigned routeId, size_t *length);
+
+/**
+ * @brief Gives the oldest year of the roads of the route.
+ * It is recomputed only if a road in the oldest year was removed or repaired since.
+ * @param[in, out] route - pointer on the route.
+ * @return the oldest year, INT32_MAX for a route without roads.
+ */
+int Route_oldestYear(Route *route);
+
+/**
+ * @brief Records that the route goes along the road.
+ * Routes of the road are kept sorted by their ids.
+ * @param[in, out] pools - pools to allocate from;
+ * @param[in, out] road  - pointer on the road from the city with the smaller id;
+ * @param[in] routeId    - id of the route;
+ * @param[in] from       - city of the route the road leaves from.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool RouteUse_add(ObjectPools *pools, Road *road, unsigned routeId, City *from);
 
 /**
- * @brief Creates new RouteNode.
- * RouteNode contains reference to a city. Length and age are the parameters
- * of the road between city of the RouteNode and the city of the next RouteNode.
- * @param[in] city   - pointer on a city;
- * @param[in] length - length of the road between city and the next RouteNode city;
- * @param[in] age    - built year of the road between city and the next RouteNode city.
- * @return pointer on the created route node, or NULL if memory allocation failed.
+ * @brief Forgets that the route goes along the road.
+ * Does nothing if the route does not go along the road.
+ * @param[in, out] pools - pools the uses were allocated from;
+ * @param[in, out] road  - pointer on the road from the city with the smaller id;
+ * @param[in] routeId    - id of the route.
  */
-RouteNode *RouteNode_create(City *city, unsigned length, int age);
+void RouteUse_remove(ObjectPools *pools, Road *road, unsigned routeId);
 
 /**
  * @brief Checks if city1 and city2 are connected.
- * Enough to check for only one pair.
+ * Enough to check for only one pair. The road is looked up in the index
+ * of roads instead of scanning the adjacency list of city1.
+ * @param[in] roads - pointer on the index of roads;
  * @param[in] city1 - pointer on the city1;
  * @param[in] city2 - pointer on the city2.
  * @return pointer on the road if city2 is in city1's adjacency list, otherwise NULL.
  */
-Road *areConnected(City *city1, City *city2);
+Road *areConnected(EdgeIndex *roads, City *city1, City *city2);
 
 #endif //GRAPHS_CITYROAD_H
@@ -1,655 +1,695 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 #include "Commands.h"
+#include "LineReader.h"
+#include "LineWriter.h"
+#include "Fields.h"
+#include "RingQueue.h"
 
 #define COMMANDS_SIZE 7
-#define COMMAND_SIZE 20
-#define CITYNAME_SIZE 20
-#define LENGTH_SIZE 21
-#define YEAR_SIZE 11
-#define ROUTEID_SIZE 4
+#define ROUTEID_MAX 999
+#define BATCH_COMMANDS 4096
+#define BATCH_TEXT (1 << 18)
+#define BATCH_ITEMS 1024
+#define PIPELINE_BATCHES 4
 
 enum cmdEnum {
-    ADD, REPAIR, GETROUTE, NEWROUTE, EXTEND, REMOVE, REMOVEROUTE
+    ADD, REPAIR, GETROUTE, NEWROUTE, EXTEND, REMOVE, REMOVEROUTE, ROUTE, WRONG, FAILED
 };
 
-char *getCommand(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    char *command = (char *) malloc(COMMAND_SIZE * sizeof(char));
+/* A command parsed from a line. Its names are keys of the batch from index names on,
+ * a route description has one more name than roads. */
+typedef struct Command {
+    enum cmdEnum kind;
+    int line;
+    unsigned routeId;
+    unsigned length;
+    int year;
+    uint32_t names;
+    uint32_t firstRoad; /* Index of the first road of a route description in the batch */
+    uint32_t roads; /* Number of roads of a route description with a correct length and year */
+    bool broken; /* Whether a road of the description after them has a wrong length or year */
+} Command;
+
+/* Length and year of a road of a route description */
+typedef struct RouteRoad {
+    unsigned length;
+    int year;
+} RouteRoad;
+
+/* Commands parsed from consecutive lines, together with the lines if they had to be copied */
+typedef struct CommandBatch {
+    Command *commands;
+    size_t count;
+    NameKey *keys;
+    size_t keyCount;
+    size_t keyCapacity;
+    RouteRoad *roads;
+    size_t roadCount;
+    size_t roadCapacity;
+    char *text;
+    size_t textSize;
+    size_t textCapacity;
+    bool waiting; /* Whether the input had to be waited for after this batch */
+    bool last; /* Whether no batch follows this one */
+} CommandBatch;
+
+/* Writers of the results and of the errors, which share one if both go to the same file */
+typedef struct Output {
+    LineWriter *results;
+    LineWriter *errors;
+} Output;
+
+/* State of splitting the input into commands */
+typedef struct Parser {
+    LineReader *reader;
+    Fields fields;
+    int line;
+} Parser;
+
+/* Batches going around between the thread parsing the input and the one running the commands */
+typedef struct Pipeline {
+    Parser parser;
+    RingQueue *parsed; /* Batches ready to be run, in the order of the input */
+    RingQueue *spare; /* Batches already run, to be filled again */
+    CommandBatch batches[PIPELINE_BATCHES];
+} Pipeline;
+
+/* Reads a decimal number without a sign, not greater than max */
+static bool parseNumber(const Field *field, uint64_t max, uint64_t *value) {
+    if (field->length == 0)
+        return false;
+
+    uint64_t result = 0;
+
+    for (size_t i = 0; i < field->length; i++) {
+        char digit = field->chars[i];
+
+        if (digit < '0' || digit > '9')
+            return false;
 
-    if (command == NULL)
-        return NULL;
+        result = 10 * result + (digit - '0');
 
-    while ((input = getchar()) != ';') {
-        if (input == '\n' || input == EOF) {
-            *whiteChar = input;
-            free(command);
-            return NULL;
-        }
-
-        command[currentSize] = input;
-        currentSize++;
+        if (result > max)
+            return false;
     }
 
-    command[currentSize] = '\0';
-    *whiteChar = ';';
+    *value = result;
 
-    return command;
+    return true;
 }
 
-int getRouteId(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    char *id = (char *) malloc(ROUTEID_SIZE * sizeof(char));
+static bool parseRouteId(const Field *field, unsigned *routeId) {
+    uint64_t value;
 
-    while ((input = getchar()) != '\n' || input != ';') {
-        if (input == EOF) {
-            free(id);
-            *whiteChar = EOF;
-            return 0;
-        }
+    if (!parseNumber(field, ROUTEID_MAX, &value) || value == 0)
+        return false;
 
-        id[currentSize] = input;
-        currentSize++;
+    *routeId = value;
 
-        if (currentSize == 4) {
-            free(id);
-            int n;
-            while ((n = getchar()) != '\n') {
-                if (n == EOF) {
-                    *whiteChar = EOF;
-                    return 0;
-                }
-            }
+    return true;
+}
 
-            return 0;
-        }
-    }
+static bool parseLength(const Field *field, unsigned *length) {
+    uint64_t value;
 
-    *whiteChar = input;
-    id[currentSize] = '\0';
-    int idInt = strtol(id, NULL, 10);
-    free(id);
+    if (!parseNumber(field, UINT_MAX, &value))
+        return false;
 
-    if (idInt > 0 && idInt < 1000)
-        return idInt;
-    else
-        return 0;
+    *length = value;
+
+    return true;
 }
 
-char *getCity1(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    int size = CITYNAME_SIZE;
-    char *cityName = (char *) malloc(size * sizeof(char));
+static bool parseYear(const Field *field, int *year) {
+    uint64_t value;
 
-    while ((input = getchar()) != ';') {
-        if (input == EOF || input == '\n') {
-            *whiteChar = input;
-            free(cityName);
-            return NULL;
-        }
+    if (field->length > 0 && field->chars[0] == '-') {
+        Field digits = {field->chars + 1, field->length - 1};
 
-        if (currentSize == size) {
-            size = 2 * currentSize;
-            cityName = (char *) realloc(cityName, size * sizeof(char));
-        }
+        if (!parseNumber(&digits, (uint64_t) INT_MAX + 1, &value))
+            return false;
 
-        cityName[currentSize] = input;
-        currentSize++;
+        *year = value > INT_MAX ? INT_MIN : -(int) value;
+        return true;
     }
 
-    cityName[currentSize] = '\0';
-    *whiteChar = input;
+    if (!parseNumber(field, INT_MAX, &value))
+        return false;
 
-    return cityName;
-}
+    *year = value;
 
-char *getCity2(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    int size = CITYNAME_SIZE;
-    char *cityName = (char *) malloc(size * sizeof(char));
+    return true;
+}
 
-    while ((input = getchar()) != ';' || input != '\n') {
-        if (input == EOF) {
-            *whiteChar = input;
-            free(cityName);
-            return NULL;
-        }
+static bool initBatch(CommandBatch *batch) {
+    batch->commands = (Command *) malloc(BATCH_COMMANDS * sizeof(Command));
+    batch->keys = (NameKey *) malloc(BATCH_ITEMS * sizeof(NameKey));
+    batch->roads = (RouteRoad *) malloc(BATCH_ITEMS * sizeof(RouteRoad));
+    batch->text = (char *) malloc(BATCH_TEXT);
+    batch->keyCapacity = BATCH_ITEMS;
+    batch->roadCapacity = BATCH_ITEMS;
+    batch->textCapacity = BATCH_TEXT;
 
-        if (currentSize == size) {
-            size = 2 * currentSize;
-            cityName = (char *) realloc(cityName, size * sizeof(char));
-        }
+    return batch->commands != NULL && batch->keys != NULL && batch->roads != NULL && batch->text != NULL;
+}
 
-        cityName[currentSize] = input;
-        currentSize++;
-    }
+static void clearBatch(CommandBatch *batch) {
+    batch->count = 0;
+    batch->keyCount = 0;
+    batch->roadCount = 0;
+    batch->textSize = 0;
+    batch->waiting = false;
+    batch->last = false;
+}
 
-    *whiteChar = input;
-    cityName[currentSize] = '\0';
-    return cityName;
+static void freeBatch(CommandBatch *batch) {
+    free(batch->commands);
+    free(batch->keys);
+    free(batch->roads);
+    free(batch->text);
 }
 
-uint64_t getLength(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    char *length = (char *) malloc(LENGTH_SIZE * sizeof(char));
+/* Grows the array of items of the given size when it is full */
+static bool reserveItem(void **items, size_t *capacity, size_t count, size_t size) {
+    if (count < *capacity)
+        return true;
 
-    while ((input = getchar()) != ';') {
-        if (input == EOF || input == '\n') {
-            *whiteChar = input;
-            free(length);
-            return 0;
-        }
+    void *grown = realloc(*items, 2 * *capacity * size);
 
-        length[currentSize] = input;
-        currentSize++;
-
-        if (currentSize == 21) {
-            free(length);
-            int n;
-            while ((n = getchar()) != '\n') {
-                if (n == EOF) {
-                    *whiteChar = EOF;
-                    return 0;
-                }
-            }
-            return 0;
-        }
-    }
+    if (grown == NULL)
+        return false;
 
-    *whiteChar = input;
-    length[currentSize] = '\0';
-    int lengthInt = strtol(length, NULL, 10);
-    free(length);
+    *items = grown;
+    *capacity *= 2;
 
-    if (lengthInt > 0)
-        return lengthInt;
-    else
-        return 0;
+    return true;
 }
 
-int getYear(int *whiteChar) {
-    int input;
-    int currentSize = 0;
-    char *year = (char *) malloc(YEAR_SIZE * sizeof(char));
+/* Hashes the name now, so the thread running the command only looks it up */
+static bool addKey(CommandBatch *batch, const Field *field) {
+    if (!reserveItem((void **) &batch->keys, &batch->keyCapacity, batch->keyCount, sizeof(NameKey)))
+        return false;
 
-    while (((input = getchar()) != ';') && input != '\n') {
-        if (input == EOF) {
-            *whiteChar = input;
-            free(year);
-            return 0;
-        }
+    batch->keys[batch->keyCount++] = Name_key(field->chars, field->length);
 
-        year[currentSize] = input;
-        currentSize++;
-
-        if (currentSize == 11) {
-            free(year);
-            int n;
-            while ((n = getchar()) != '\n') {
-                if (n == EOF) {
-                    *whiteChar = EOF;
-                    return 0;
-                }
-            }
-            return 0;
-        }
-    }
+    return true;
+}
 
-    *whiteChar = input;
-    year[currentSize] = '\0';
-    int lengthInt = strtol(year, NULL, 10);
-    free(year);
+static bool addRouteRoad(CommandBatch *batch, RouteRoad road) {
+    if (!reserveItem((void **) &batch->roads, &batch->roadCapacity, batch->roadCount, sizeof(RouteRoad)))
+        return false;
 
-    if (lengthInt != 0)
-        return lengthInt;
-    else
-        return 0;
+    batch->roads[batch->roadCount++] = road;
+
+    return true;
 }
 
-void UnusedManual_free(Route *route) {
-    if (route == NULL)
-        return;
+/* Copies the line behind the lines of the batch, the text may only grow while no key points into it */
+static char *copyLine(CommandBatch *batch, const char *chars, size_t length) {
+    if (batch->textSize + length + 1 > batch->textCapacity) {
+        char *text = (char *) realloc(batch->text, batch->textSize + length + 1);
 
-    RouteNode *current = route->routeNodeList->head;
+        if (text == NULL)
+            return NULL;
 
-    while (current != NULL) {
-        RouteNode *next = current->next;
-        free(current);
-        current = next;
+        batch->text = text;
+        batch->textCapacity = batch->textSize + length + 1;
     }
 
-    free(route->routeNodeList);
-    free(route);
-}
+    char *copy = batch->text + batch->textSize;
+    memcpy(copy, chars, length + 1);
+    batch->textSize += length + 1;
 
-bool extendManualRoute(Map *map, Route *route) {
-    int whiteChar;
-    do {
-        uint64_t length = getLength(&whiteChar);
+    return copy;
+}
 
-        if (whiteChar == EOF || whiteChar == '\n')
+/* Adds the keys of count fields from the field with index first on */
+static bool addKeys(CommandBatch *batch, const Fields *fields, size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        if (!addKey(batch, &fields->items[i]))
             return false;
+    }
 
-        int year = getYear(&whiteChar);
+    return true;
+}
 
-        if (whiteChar == EOF || whiteChar == '\n')
-            return false;
+/* Parses the number of a route followed by the first city and the roads, three fields each.
+ * The roads before one with a wrong length or year are still added to the map,
+ * so the description is cut at that road instead of being rejected. */
+static bool parseRouteDescription(CommandBatch *batch, const Fields *fields, Command *command) {
+    if (fields->count < 5 || (fields->count - 2) % 3 != 0)
+        return true;
 
-        char *city = getCity2(&whiteChar);
+    command->kind = ROUTE;
+    command->firstRoad = batch->roadCount;
+    command->roads = 0;
+    command->broken = false;
 
-        if (whiteChar == EOF) {
-            free(city);
-            return false;
-        }
+    if (!addKey(batch, &fields->items[1]))
+        return false;
 
-        RouteNode *prev = route->routeNodeList->tail;
-        City *city2 = search_hmap(map->nameToCity, city);
+    for (size_t i = 1; i + 3 < fields->count; i += 3) {
+        RouteRoad road;
 
-        if (city2 == NULL) {
-            addRoad(map, prev->city->cityName, city, length, year);
+        if (!parseLength(&fields->items[i + 1], &road.length) || !parseYear(&fields->items[i + 2], &road.year)) {
+            command->broken = true;
+            return true;
         }
 
-        city2 = search_hmap(map->nameToCity, city);
-        Road *roadBetween = areConnected(prev->city, city2);
-
-        if (roadBetween != NULL && roadBetween->builtYear <= year) {
-            RouteNode *routeNode = RouteNode_create(city2, length, year);
-            prev->next = routeNode;
-            route->routeNodeList->tail = routeNode;
-        } else {
-            free(city);
+        if (!addRouteRoad(batch, road) || !addKey(batch, &fields->items[i + 3]))
             return false;
-        }
 
-    } while (whiteChar == ';');
+        command->roads++;
+    }
 
     return true;
 }
 
-void addRouteManual(Map *map, int routeNumber, int *whiteChar, int *line) {
-    if (map->routes[routeNumber] != NULL) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+/* Parses the line split into fields, a wrong command is left as it is.
+ * Gives false if memory allocation failed. */
+static bool parseFields(CommandBatch *batch, const Fields *fields, Command *command) {
+    static const char *commands[COMMANDS_SIZE] = {"addRoad", "repairRoad", "getRouteDescription", "newRoute",
+                                                  "extendRoute", "removeRoad", "removeRoute"};
+    const Field *items = fields->items;
+    command->names = batch->keyCount;
 
-    char *firstCity = getCity1(whiteChar);
+    // A line starting with a route number describes the whole route
+    if (parseRouteId(&items[0], &command->routeId))
+        return parseRouteDescription(batch, fields, command);
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    int index = 0;
+    while (index < COMMANDS_SIZE && strcmp(items[0].chars, commands[index]) != 0)
+        index++;
 
-    uint64_t length = getLength(whiteChar);
+    bool correct;
+    size_t firstName = 1;
+    size_t names = 0;
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    switch (index) {
+        case ADD:
+            correct = fields->count == 5 && parseLength(&items[3], &command->length) &&
+                      parseYear(&items[4], &command->year);
+            names = 2;
+            break;
+        case REPAIR:
+            correct = fields->count == 4 && parseYear(&items[3], &command->year);
+            names = 2;
+            break;
+        case GETROUTE:
+        case REMOVEROUTE:
+            correct = fields->count == 2 && parseRouteId(&items[1], &command->routeId);
+            break;
+        case NEWROUTE:
+            correct = fields->count == 4 && parseRouteId(&items[1], &command->routeId);
+            firstName = 2;
+            names = 2;
+            break;
+        case EXTEND:
+            correct = fields->count == 3 && parseRouteId(&items[1], &command->routeId);
+            firstName = 2;
+            names = 1;
+            break;
+        case REMOVE:
+            correct = fields->count == 3;
+            names = 2;
+            break;
+        default:
+            correct = false;
     }
 
-    int year = getYear(whiteChar);
+    if (!correct)
+        return true;
 
-    if (*whiteChar == EOF || *whiteChar != ';') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    command->kind = index;
 
-    char *secondCity = getCity1(whiteChar);
+    return addKeys(batch, fields, firstName, names);
+}
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+/* Parses the line into the batch, which has room for one more command. With copy set the line
+ * is copied into the batch first, so it does not have to outlive the next read.
+ * Gives false when nothing more should be read. */
+static bool parseLine(Parser *parser, CommandBatch *batch, char *chars, size_t length, bool terminated, bool copy) {
+    // Empty lines are skipped and do not count as lines of commands
+    if (length == 0)
+        return true;
+
+    int line = parser->line++;
+
+    if (chars[0] == '#' && terminated)
+        return true;
+
+    Command *command = &batch->commands[batch->count++];
+    command->kind = WRONG;
+    command->line = line;
+
+    // Comments, like commands, have to end with a newline, and such a comment ends the input
+    if (chars[0] == '#')
+        return false;
+
+    if (!terminated)
+        return true;
+
+    if (copy && (chars = copyLine(batch, chars, length)) == NULL) {
+        command->kind = FAILED;
+        return false;
     }
 
-    City *city1 = search_hmap(map->nameToCity, firstCity);
-    City *city2 = search_hmap(map->nameToCity, secondCity);
-
-    if (city1 == NULL || city2 == NULL)
-        addRoad(map, firstCity, secondCity, length, year);
-
-    Road *roadbetween = areConnected(city1, city2);
-
-    if (roadbetween != NULL && year >= roadbetween->builtYear) {
-        Route *route = Route_create();
-        RouteNode *head = RouteNode_create(city1, length, year);
-        RouteNode *next = RouteNode_create(city2, 0, 0);
-        head->next = next;
-        route->routeNodeList->head = head;
-        route->routeNodeList->tail = next;
-        if (extendManualRoute(map, route)) {
-            map->routes[routeNumber] = route;
-        } else {
-            UnusedManual_free(route);
-            free(firstCity);
-            free(secondCity);
-            fprintf(stderr, "ERROR %d\n", *line);
-            return;
-        }
-    } else {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    // Delimiters are found and forbidden characters rejected in one pass over the line
+    if (!Fields_split(&parser->fields, chars, length) ||
+        (parser->fields.valid && !parseFields(batch, &parser->fields, command))) {
+        command->kind = FAILED;
+        return false;
     }
-    printf("Bro\n");
-}
 
-void addRoadCommand(Map *map, int *whiteChar, int *line) {
-    char *firstCity = getCity1(whiteChar);
+    return true;
+}
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+/* Marks the end of the input in the batch, which has room for one more command */
+static void endInput(Parser *parser, CommandBatch *batch) {
+    if (parser->reader->failed) {
+        Command *command = &batch->commands[batch->count++];
+        command->kind = FAILED;
+        command->line = parser->line;
     }
+}
 
-    char *secondCity = getCity1(whiteChar);
+/* Goes along the roads of the description, adding the ones to cities which do not exist yet.
+ * A road which exists has to have the given length, it is repaired if the given year is later. */
+static bool extendManualRoute(Map *map, Route *route, const CommandBatch *batch, const Command *command) {
+    const NameKey *names = batch->keys + command->names;
+    const RouteRoad *roads = batch->roads + command->firstRoad;
+
+    for (uint32_t i = 0; i < command->roads; i++) {
+        unsigned length = roads[i].length;
+        int year = roads[i].year;
+        const NameKey *from = &names[i];
+        const NameKey *to = &names[i + 1];
+        City *city1 = search_hmap_key(map->nameToCity, from);
+        City *city2 = search_hmap_key(map->nameToCity, to);
+
+        if (city1 == NULL || city2 == NULL) {
+            addRoadKeyed(map, from, to, length, year);
+            city1 = search_hmap_key(map->nameToCity, from);
+            city2 = search_hmap_key(map->nameToCity, to);
+        }
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+        Road *roadBetween = city1 != NULL && city2 != NULL ? areConnected(map->roads, city1, city2) : NULL;
 
-    uint64_t length = getLength(whiteChar);
+        if (roadBetween == NULL || roadBetween->length != length || roadBetween->builtYear > year)
+            return false;
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+        if (roadBetween->builtYear < year && !repairRoadKeyed(map, from, to, year))
+            return false;
 
-    int year = getYear(whiteChar);
+        if (route->count == 0 && !Route_append(route, city1, 0, 0))
+            return false;
 
-    if (*whiteChar == EOF || *whiteChar != '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+        if (!Route_append(route, city2, length, year))
+            return false;
     }
 
-    bool isRight = addRoad(map, firstCity, secondCity, length, year);
+    return !command->broken;
+}
+
+static bool addRouteManual(Map *map, const CommandBatch *batch, const Command *command) {
+    if (map->routes[command->routeId] != NULL)
+        return false;
 
-    if (isRight == false) {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    Route *route = Route_create(command->roads + 1);
+
+    if (route == NULL || !extendManualRoute(map, route, batch, command) ||
+        !addRouteOnMap(map, command->routeId, route)) {
+        Route_free(route);
+        return false;
     }
+
+    return true;
 }
 
-void repairRoadCommand(Map *map, int *whiteChar, int *line) {
-    char *firstCity = getCity1(whiteChar);
+static bool printRouteDescription(Map *map, Output *output, unsigned routeId) {
+    size_t length;
+    const char *result = describeRoute(map, routeId, &length);
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    if (result == NULL)
+        return false;
 
-    char *secondCity = getCity1(whiteChar);
+    LineWriter_write(output->results, result, length);
+    LineWriter_endLine(output->results);
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    return true;
+}
 
-    int repairYear = getYear(whiteChar);
+static bool runCommand(Map *map, Output *output, const CommandBatch *batch, const Command *command) {
+    const NameKey *names = batch->keys + command->names;
 
-    if (*whiteChar == EOF || *whiteChar != '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    switch (command->kind) {
+        case ADD:
+            return addRoadKeyed(map, &names[0], &names[1], command->length, command->year);
+        case REPAIR:
+            return repairRoadKeyed(map, &names[0], &names[1], command->year);
+        case GETROUTE:
+            return printRouteDescription(map, output, command->routeId);
+        case NEWROUTE:
+            return newRouteKeyed(map, command->routeId, &names[0], &names[1]);
+        case EXTEND:
+            return extendRouteKeyed(map, command->routeId, &names[0]);
+        case REMOVE:
+            return removeRoadKeyed(map, &names[0], &names[1]);
+        case REMOVEROUTE:
+            return removeRoute(map, command->routeId);
+        case ROUTE:
+            return addRouteManual(map, batch, command);
+        default:
+            return false;
     }
+}
 
-    bool isRight = repairRoad(map, firstCity, secondCity, repairYear);
+/* Runs the commands of the batch in order. Gives false at a command which could not
+ * be parsed for lack of memory, the commands behind it are not run. */
+static bool runBatch(Map *map, Output *output, const CommandBatch *batch) {
+    for (size_t i = 0; i < batch->count; i++) {
+        const Command *command = &batch->commands[i];
 
-    if (isRight == false) {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+        if (command->kind == FAILED)
+            return false;
+
+        if (!runCommand(map, output, batch, command)) {
+            LineWriter_write(output->errors, "ERROR ", 6);
+            LineWriter_writeNumber(output->errors, command->line);
+            LineWriter_endLine(output->errors);
+        }
     }
+
+    return true;
 }
 
-void getRouteDescrCommand(Map *map, int *whiteChar, int *line) {
-    int id = getRouteId(whiteChar);
+static bool initOutput(Output *output) {
+    output->results = LineWriter_create(stdout);
+    output->errors = NULL;
 
-    if (*whiteChar == EOF || *whiteChar != '\n' || id == 0) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    if (output->results == NULL)
+        return false;
 
-    const char *result = getRouteDescription(map, id);
+    // Through one writer the results and the errors keep the order of the commands
+    if (LineWriter_sameFile(output->results, stderr))
+        output->errors = output->results;
+    else
+        output->errors = LineWriter_create(stderr);
 
-    if (result == NULL) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    } else {
-        fprintf(stdout, "%s", result);
-    }
+    return output->errors != NULL;
 }
 
-void newRouteCommand(Map *map, int *whiteChar, int *line) {
-    int id = getRouteId(whiteChar);
+/* Writes out everything collected so far */
+static void flushOutput(Output *output) {
+    LineWriter_flush(output->results);
+    LineWriter_flush(output->errors);
+}
 
-    if (*whiteChar == EOF || *whiteChar != ';' || id == 0) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+static void freeOutput(Output *output) {
+    if (output->errors != output->results)
+        LineWriter_free(output->errors);
 
-    char *firstCity = getCity1(whiteChar);
+    LineWriter_free(output->results);
+}
 
-    if (*whiteChar == EOF || *whiteChar != ';') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+static bool initParser(Parser *parser) {
+    parser->reader = LineReader_create(stdin);
+    parser->line = 1;
+    Fields_init(&parser->fields);
 
-    char *secondCity = getCity2(whiteChar);
+    return parser->reader != NULL;
+}
 
-    if (*whiteChar == EOF || *whiteChar != '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+static void freeParser(Parser *parser) {
+    Fields_free(&parser->fields);
+    LineReader_free(parser->reader);
+}
 
-    bool isRight = newRoute(map, id, firstCity, secondCity);
+void execCommand(Map *map) {
+    Parser parser;
+    CommandBatch batch;
+    Output output;
+    char *chars;
+    size_t length;
+    bool terminated;
+    bool reading = true;
+    bool failed = false;
 
-    if (isRight == false) {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    if (!initParser(&parser) || !initBatch(&batch) || !initOutput(&output))
+        exit(1);
+
+    clearBatch(&batch);
+
+    // Every line is run as soon as it is parsed, straight from the buffer of the reader
+    while (!failed && reading && LineReader_next(parser.reader, &chars, &length, &terminated)) {
+        reading = parseLine(&parser, &batch, chars, length, terminated, false);
+        failed = !runBatch(map, &output, &batch);
+        clearBatch(&batch);
+
+        // The output is written before waiting for more input, which may depend on it
+        if (!LineReader_ready(parser.reader))
+            flushOutput(&output);
+    }
+
+    if (!failed) {
+        endInput(&parser, &batch);
+        failed = !runBatch(map, &output, &batch);
     }
+
+    freeOutput(&output);
+    freeBatch(&batch);
+    freeParser(&parser);
+
+    if (failed)
+        exit(1);
 }
 
-void extendRouteCommand(Map *map, int *whiteChar, int *line) {
-    int id = getRouteId(whiteChar);
+/* Hands the batch over to be run and takes the next one to fill */
+static CommandBatch *passBatch(Pipeline *pipeline, CommandBatch *batch) {
+    // The queue has room for all batches, so it is never full
+    RingQueue_push(pipeline->parsed, batch);
 
-    if (*whiteChar == EOF || *whiteChar != ';' || id == 0) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    CommandBatch *next = (CommandBatch *) RingQueue_pop(pipeline->spare);
+    clearBatch(next);
 
-    char *extendTo = getCity2(whiteChar);
+    return next;
+}
 
-    if (*whiteChar == EOF || *whiteChar != '\n') {
-        free(extendTo);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+static void *parseInput(void *argument) {
+    Pipeline *pipeline = (Pipeline *) argument;
+    Parser *parser = &pipeline->parser;
+    CommandBatch *batch = (CommandBatch *) RingQueue_pop(pipeline->spare);
+    char *chars;
+    size_t length;
+    bool terminated;
+    bool reading = true;
 
-    bool isRight = extendRoute(map, id, extendTo);
+    clearBatch(batch);
 
-    if (isRight == false) {
-        free(extendTo);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    while (reading && LineReader_next(parser->reader, &chars, &length, &terminated)) {
+        // Keys point into the text of the batch, so a line which does not fit goes to the next one
+        if (batch->count > 0 && batch->textSize + length + 1 > batch->textCapacity)
+            batch = passBatch(pipeline, batch);
+
+        reading = parseLine(parser, batch, chars, length, terminated, true);
+
+        // Before waiting for more input, so commands typed in a terminal are run at once
+        // and the output of the batch is written even if it is empty
+        bool waiting = !LineReader_ready(parser->reader);
+
+        if (batch->count == BATCH_COMMANDS || waiting) {
+            batch->waiting = waiting;
+            batch = passBatch(pipeline, batch);
+        }
     }
+
+    endInput(parser, batch);
+    batch->last = true;
+    RingQueue_push(pipeline->parsed, batch);
+
+    return NULL;
 }
 
-void removeRoadCommand(Map *map, int *whiteChar, int *line) {
-    char *firstCity = getCity1(whiteChar);
+static void freePipeline(Pipeline *pipeline, int batches) {
+    for (int i = 0; i < batches; i++)
+        freeBatch(&pipeline->batches[i]);
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    RingQueue_free(pipeline->parsed);
+    RingQueue_free(pipeline->spare);
+    freeParser(&pipeline->parser);
+    free(pipeline);
+}
 
-    char *secondCity = getCity1(whiteChar);
+static Pipeline *createPipeline(void) {
+    Pipeline *pipeline = (Pipeline *) malloc(sizeof(Pipeline));
+    if (pipeline == NULL)
+        return NULL;
 
-    if (*whiteChar == EOF || *whiteChar == '\n') {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
+    bool created = initParser(&pipeline->parser);
+    pipeline->parsed = RingQueue_create(PIPELINE_BATCHES);
+    pipeline->spare = RingQueue_create(PIPELINE_BATCHES);
 
-    bool isRight = removeRoad(map, firstCity, secondCity);
+    int batches = 0;
+    while (created && batches < PIPELINE_BATCHES) {
+        created = initBatch(&pipeline->batches[batches]);
+        batches++;
+    }
 
-    if (isRight == false) {
-        free(firstCity);
-        free(secondCity);
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
+    if (!created || pipeline->parsed == NULL || pipeline->spare == NULL) {
+        freePipeline(pipeline, batches);
+        return NULL;
     }
+
+    for (int i = 0; i < PIPELINE_BATCHES; i++)
+        RingQueue_push(pipeline->spare, &pipeline->batches[i]);
+
+    return pipeline;
 }
 
-void removeRouteCommand(Map *map, int *whiteChar, int *line) {
-    int id = getRouteId(whiteChar);
+void execCommandPipelined(Map *map) {
+    Pipeline *pipeline = createPipeline();
+    Output output;
+    pthread_t parsing;
 
-    if (*whiteChar == EOF || *whiteChar != '\n' || id == 0) {
-        fprintf(stderr, "ERROR %d\n", *line);
+    if (pipeline == NULL || !initOutput(&output))
+        exit(1);
+
+    // Without a second thread the commands are parsed and run one by one
+    if (pthread_create(&parsing, NULL, parseInput, pipeline) != 0) {
+        freeOutput(&output);
+        freePipeline(pipeline, PIPELINE_BATCHES);
+        execCommand(map);
         return;
     }
 
-    bool isRight = removeRoute(map, id);
+    bool failed = false;
+    bool last = false;
 
-    if (isRight == false) {
-        fprintf(stderr, "ERROR %d\n", *line);
-        return;
-    }
-}
+    while (!last) {
+        CommandBatch *batch = (CommandBatch *) RingQueue_pop(pipeline->parsed);
 
-void doOperation(Map *map, int index, int *whiteChar, int *line) {
-    switch (index) {
-        case ADD:
-            addRoadCommand(map, whiteChar, line);
-            break;
-        case REPAIR:
-            repairRoadCommand(map, whiteChar, line);
-            break;
-        case GETROUTE:
-            getRouteDescrCommand(map, whiteChar, line);
-            break;
-        case NEWROUTE:
-            newRouteCommand(map, whiteChar, line);
-            break;
-        case EXTEND:
-            extendRouteCommand(map, whiteChar, line);
-            break;
-        case REMOVE:
-            removeRoadCommand(map, whiteChar, line);
-            break;
-        case REMOVEROUTE:
-            removeRouteCommand(map, whiteChar, line);
-            break;
-        default: {
-            fprintf(stderr, "ERROR %d\n", *line);
-            break;
-        }
-    }
-}
+        // After a failure the remaining batches are only taken, so the parsing thread can finish
+        failed = failed || !runBatch(map, &output, batch);
+        last = batch->last;
 
-void execCommand(Map *map) {
-    char *commands[COMMANDS_SIZE] = {"addRoad", "repairRoad", "getRouteDescription", "newRoute", "extendRoute",
-                                     "removeRoad", "removeRoute"};
-    int input;
-    int line = 1;
-
-    while ((input = getchar()) != EOF) {
-        if (input == '#') {
-            do {
-                // Get whole line and ignore
-                input = getchar();
-                if (input == EOF) {
-                    fprintf(stderr, "ERROR %d\n", line);
-                    return;
-                }
-            } while (input != '\n');
-
-            line++;
-            continue;
-        }
+        if (batch->waiting)
+            flushOutput(&output);
 
-        if (input != '\n') {
-            int index = -1;
-            int whiteChar;
-
-            ungetc(input, stdin);
-            char *command = getCommand(&whiteChar);
-
-            if (command == NULL && whiteChar == '\n') {
-                fprintf(stderr, "ERROR %d\n", line);
-                line++;
-            }
-
-            if (command == NULL && whiteChar == EOF) {
-                fprintf(stderr, "ERROR %d\n", line);
-                return;
-            }
-
-            int routeNumber = 0;
-
-            if (command != NULL) {
-                routeNumber = strtol(command, NULL, 10);
-            }
-
-            if (routeNumber > 0 && routeNumber < 1000) {
-                addRouteManual(map, routeNumber, &whiteChar, &line);
-                line++;
-            } else if (command != NULL) {
-                for (int i = 0; i < COMMANDS_SIZE; i++) {
-                    if (strcmp(command, commands[i]) == 0) {
-                        index = i;
-                        break;
-                    }
-                }
-
-                doOperation(map, index, &whiteChar, &line);
-                line++;
-            }
-
-            if (whiteChar != '\n') {
-                do {
-                    input = getchar();
-
-                    if (input == EOF) {
-                        free(command);
-                        return;
-                    }
-                } while (input != '\n');
-            }
-
-            free(command);
-        }
+        // Once given back, the batch may be filled again at any moment
+        if (!last)
+            RingQueue_push(pipeline->spare, batch);
     }
+
+    pthread_join(parsing, NULL);
+    freeOutput(&output);
+    freePipeline(pipeline, PIPELINE_BATCHES);
+
+    if (failed)
+        exit(1);
 }
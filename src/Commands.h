@@ -11,4 +11,13 @@
  */
 void execCommand(Map *map);
 
+/** @brief Gets the commands and executes them, parsing on a separate thread.
+ * The input is parsed in batches of lines ahead of the commands being run,
+ * which are still run one by one in the order of the input, so the output
+ * is the same as of @ref execCommand. If the thread cannot be started,
+ * the commands are parsed and run like in @ref execCommand.
+ * @param[in,out] map - pointer on a map.
+ */
+void execCommandPipelined(Map *map);
+
 #endif //DROGI_COMMANDS_H
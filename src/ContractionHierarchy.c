@@ -0,0 +1,429 @@
+#include <stdlib.h>
+#include "ContractionHierarchy.h"
+#include "Heap.h"
+#include "SearchWorkspace.h"
+
+/* Witness searches give up after settling this many cities. A witness which
+ * is not found only costs a superfluous shortcut, never a wrong answer. */
+#define WITNESS_SETTLE_LIMIT 128
+#define SIMULATION_SETTLE_LIMIT 8
+#define PRIORITY_OFFSET ((uint64_t) 1 << 62)
+#define INITIAL_EDGES 4
+
+typedef struct ChEdge {
+    uint64_t target;
+    uint64_t length;
+    uint64_t middle;
+    uint8_t paths;
+} ChEdge;
+
+typedef struct ChAdjacency {
+    uint64_t size;
+    uint64_t capacity;
+    ChEdge *edges;
+} ChAdjacency;
+
+/* State of one contraction. The adjacency lists hold only the edges
+ * between cities which are not contracted yet. */
+typedef struct ChBuilder {
+    uint64_t n;
+    ChAdjacency *adj;
+    uint64_t *contractedNeighbours;
+    uint64_t *priorities;
+    uint64_t *neighbours;
+    uint64_t *targetRound;
+    uint64_t round;
+    SearchWorkspace *ws;
+    Heap *heap;
+    ChEdge *up;
+    uint64_t *upOwner;
+    uint64_t upSize;
+    uint64_t upCapacity;
+} ChBuilder;
+
+ContractionHierarchy *ContractionHierarchy_create(void) {
+    ContractionHierarchy *ch = (ContractionHierarchy *) malloc(sizeof(ContractionHierarchy));
+
+    if (ch == NULL)
+        return NULL;
+
+    ch->nVertices = 0;
+    ch->rank = NULL;
+    ch->offsets = NULL;
+    ch->targets = NULL;
+    ch->lengths = NULL;
+    ch->paths = NULL;
+    ch->middles = NULL;
+    ch->requested = false;
+    ch->valid = false;
+    ch->staleQueries = 0;
+
+    return ch;
+}
+
+static inline uint8_t multiplyPaths(uint8_t paths1, uint8_t paths2) {
+    return paths1 * paths2 < 2 ? paths1 * paths2 : 2;
+}
+
+static bool pushEdge(ChAdjacency *adj, ChEdge edge) {
+    if (adj->size == adj->capacity) {
+        uint64_t capacity = adj->capacity == 0 ? INITIAL_EDGES : 2 * adj->capacity;
+        ChEdge *edges = (ChEdge *) realloc(adj->edges, capacity * sizeof(ChEdge));
+
+        if (edges == NULL)
+            return false;
+
+        adj->edges = edges;
+        adj->capacity = capacity;
+    }
+
+    adj->edges[adj->size++] = edge;
+
+    return true;
+}
+
+static ChEdge *findEdge(ChAdjacency *adj, uint64_t target) {
+    for (uint64_t i = 0; i < adj->size; i++) {
+        if (adj->edges[i].target == target)
+            return &adj->edges[i];
+    }
+
+    return NULL;
+}
+
+static void removeEdge(ChAdjacency *adj, uint64_t target) {
+    ChEdge *edge = findEdge(adj, target);
+
+    if (edge != NULL)
+        *edge = adj->edges[--adj->size];
+}
+
+/* Adds the shortcut in both directions. A shorter one replaces an existing
+ * edge, one of equal length adds its paths to it. */
+static bool connect(ChBuilder *b, uint64_t u, uint64_t w, uint64_t length, uint64_t middle, uint8_t paths) {
+    for (int side = 0; side < 2; side++) {
+        uint64_t from = side == 0 ? u : w;
+        uint64_t to = side == 0 ? w : u;
+        ChEdge *edge = findEdge(&b->adj[from], to);
+        ChEdge shortcut = {to, length, middle, paths};
+
+        if (edge == NULL) {
+            if (!pushEdge(&b->adj[from], shortcut))
+                return false;
+        } else if (length < edge->length) {
+            *edge = shortcut;
+        } else if (length == edge->length) {
+            edge->paths = edge->paths + paths < 2 ? edge->paths + paths : 2;
+        }
+    }
+
+    return true;
+}
+
+/* Dijkstra from src which avoids the city being contracted. It stops at maxDist,
+ * after settling limit cities or when all targets marked with the current round are settled. */
+static void witnessSearch(ChBuilder *b, uint64_t src, uint64_t skipped, uint64_t maxDist, uint64_t targets,
+                          unsigned limit) {
+    SearchWorkspace *ws = b->ws;
+    unsigned settled = 0;
+    uint64_t u;
+
+    // The builder keeps the heap, which has room for every city, so relaxing never fails
+    SearchWorkspace_begin(ws, b->n);
+    SearchWorkspace_relax(ws, src, 0, 0, 0, NULL);
+
+    while (targets > 0 && (u = SearchWorkspace_extractMin(ws)) != UINT64_MAX && ws->dist[u] < maxDist &&
+           settled++ < limit) {
+        if (b->targetRound[u] == b->round)
+            targets--;
+
+        ChAdjacency *adj = &b->adj[u];
+
+        for (uint64_t i = 0; i < adj->size; i++) {
+            uint64_t v = adj->edges[i].target;
+            uint64_t dist = ws->dist[u] + adj->edges[i].length;
+
+            if (v != skipped && !SearchWorkspace_isSettled(ws, v) && dist < SearchWorkspace_dist(ws, v))
+                SearchWorkspace_relax(ws, v, dist, dist, 0, NULL);
+        }
+    }
+}
+
+/* Counts the shortcuts needed to contract v and adds them if add is set.
+ * A pair of neighbours needs one unless a strictly shorter path avoids v.
+ * Returns -1 if memory allocation failed. */
+static int64_t shortcuts(ChBuilder *b, uint64_t v, bool add) {
+    ChAdjacency *adj = &b->adj[v];
+    uint64_t longest = 0;
+    int64_t count = 0;
+
+    for (uint64_t i = 0; i < adj->size; i++) {
+        if (adj->edges[i].length > longest)
+            longest = adj->edges[i].length;
+    }
+
+    for (uint64_t i = 0; i + 1 < adj->size; i++) {
+        ChEdge in = adj->edges[i];
+
+        // Only the neighbours after in are targets, earlier pairs were checked already
+        b->round++;
+        for (uint64_t j = i + 1; j < adj->size; j++)
+            b->targetRound[adj->edges[j].target] = b->round;
+
+        witnessSearch(b, in.target, v, in.length + longest, adj->size - i - 1,
+                      add ? WITNESS_SETTLE_LIMIT : SIMULATION_SETTLE_LIMIT);
+
+        for (uint64_t j = i + 1; j < adj->size; j++) {
+            ChEdge out = adj->edges[j];
+            uint64_t length = in.length + out.length;
+
+            if (SearchWorkspace_dist(b->ws, out.target) < length)
+                continue;
+
+            count++;
+
+            if (add && !connect(b, in.target, out.target, length, v, multiplyPaths(in.paths, out.paths)))
+                return -1;
+        }
+    }
+
+    return count;
+}
+
+/* Computes the priority of v and remembers it, it changes only when a neighbour is contracted */
+static uint64_t priority(ChBuilder *b, uint64_t v) {
+    int64_t edgeDifference = shortcuts(b, v, false) - (int64_t) b->adj[v].size;
+
+    b->priorities[v] = PRIORITY_OFFSET + (uint64_t) (2 * edgeDifference + (int64_t) b->contractedNeighbours[v]);
+
+    return b->priorities[v];
+}
+
+/* Adds the shortcuts around v, keeps its edges as upward ones and detaches it from its neighbours */
+static bool contract(ChBuilder *b, uint64_t v) {
+    ChAdjacency *adj = &b->adj[v];
+
+    if (shortcuts(b, v, true) < 0)
+        return false;
+
+    if (b->upSize + adj->size > b->upCapacity) {
+        uint64_t capacity = b->upCapacity == 0 ? 1024 : b->upCapacity;
+        while (capacity < b->upSize + adj->size)
+            capacity *= 2;
+
+        ChEdge *up = (ChEdge *) realloc(b->up, capacity * sizeof(ChEdge));
+        if (up == NULL)
+            return false;
+        b->up = up;
+
+        uint64_t *upOwner = (uint64_t *) realloc(b->upOwner, capacity * sizeof(uint64_t));
+        if (upOwner == NULL)
+            return false;
+        b->upOwner = upOwner;
+
+        b->upCapacity = capacity;
+    }
+
+    for (uint64_t i = 0; i < adj->size; i++) {
+        uint64_t u = adj->edges[i].target;
+
+        b->up[b->upSize] = adj->edges[i];
+        b->upOwner[b->upSize++] = v;
+        b->neighbours[i] = u;
+        removeEdge(&b->adj[u], v);
+        b->contractedNeighbours[u]++;
+    }
+
+    free(adj->edges);
+    adj->edges = NULL;
+    adj->size = 0;
+    adj->capacity = 0;
+
+    return true;
+}
+
+static void freeBuilder(ChBuilder *b) {
+    if (b->adj != NULL) {
+        for (uint64_t v = 0; v < b->n; v++)
+            free(b->adj[v].edges);
+    }
+
+    free(b->adj);
+    free(b->contractedNeighbours);
+    free(b->priorities);
+    free(b->neighbours);
+    free(b->targetRound);
+    free(b->up);
+    free(b->upOwner);
+
+    if (b->ws != NULL)
+        SearchWorkspace_free(b->ws);
+    if (b->heap != NULL)
+        free_Heap(b->heap);
+}
+
+/* Stores the upward edges in the compressed sparse row layout */
+static bool storeUpwardGraph(ContractionHierarchy *ch, ChBuilder *b) {
+    uint64_t *offsets = (uint64_t *) realloc(ch->offsets, (b->n + 1) * sizeof(uint64_t));
+    if (offsets == NULL)
+        return false;
+    ch->offsets = offsets;
+
+    uint64_t size = b->upSize == 0 ? 1 : b->upSize;
+
+    uint64_t *targets = (uint64_t *) realloc(ch->targets, size * sizeof(uint64_t));
+    if (targets == NULL)
+        return false;
+    ch->targets = targets;
+
+    uint64_t *lengths = (uint64_t *) realloc(ch->lengths, size * sizeof(uint64_t));
+    if (lengths == NULL)
+        return false;
+    ch->lengths = lengths;
+
+    uint8_t *paths = (uint8_t *) realloc(ch->paths, size * sizeof(uint8_t));
+    if (paths == NULL)
+        return false;
+    ch->paths = paths;
+
+    uint64_t *middles = (uint64_t *) realloc(ch->middles, size * sizeof(uint64_t));
+    if (middles == NULL)
+        return false;
+    ch->middles = middles;
+
+    for (uint64_t v = 0; v <= b->n; v++)
+        offsets[v] = 0;
+
+    for (uint64_t i = 0; i < b->upSize; i++)
+        offsets[b->upOwner[i] + 1]++;
+
+    for (uint64_t v = 0; v < b->n; v++)
+        offsets[v + 1] += offsets[v];
+
+    // The neighbour array is free now, it serves as the fill cursor of each city
+    for (uint64_t v = 0; v < b->n; v++)
+        b->neighbours[v] = offsets[v];
+
+    for (uint64_t i = 0; i < b->upSize; i++) {
+        uint64_t e = b->neighbours[b->upOwner[i]]++;
+
+        targets[e] = b->up[i].target;
+        lengths[e] = b->up[i].length;
+        paths[e] = b->up[i].paths;
+        middles[e] = b->up[i].middle;
+    }
+
+    return true;
+}
+
+bool ContractionHierarchy_build(ContractionHierarchy *ch, CsrGraph *graph) {
+    uint64_t n = graph->nVertices;
+    ChBuilder b = {n, NULL, NULL, NULL, NULL, NULL, 0, NULL, NULL, NULL, NULL, 0, 0};
+
+    ch->requested = true;
+    ch->valid = false;
+    ch->staleQueries = 0;
+
+    b.adj = (ChAdjacency *) calloc(n + 1, sizeof(ChAdjacency));
+    b.contractedNeighbours = (uint64_t *) calloc(n + 1, sizeof(uint64_t));
+    b.priorities = (uint64_t *) malloc((n + 1) * sizeof(uint64_t));
+    b.neighbours = (uint64_t *) malloc((n + 1) * sizeof(uint64_t));
+    b.targetRound = (uint64_t *) calloc(n + 1, sizeof(uint64_t));
+    b.ws = SearchWorkspace_create();
+    b.heap = Heap_create(n + 1);
+
+    uint64_t *rank = (uint64_t *) realloc(ch->rank, (n + 1) * sizeof(uint64_t));
+    if (rank != NULL)
+        ch->rank = rank;
+
+    if (b.adj == NULL || b.contractedNeighbours == NULL || b.priorities == NULL || b.neighbours == NULL || b.targetRound == NULL || b.ws == NULL ||
+        b.heap == NULL || rank == NULL || !SearchWorkspace_begin(b.ws, n)) {
+        freeBuilder(&b);
+        return false;
+    }
+
+    for (uint64_t v = 0; v < n; v++) {
+        for (uint64_t e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+            ChEdge road = {graph->targets[e], graph->lengths[e], HIERARCHY_NO_MIDDLE, 1};
+
+            if (!pushEdge(&b.adj[v], road)) {
+                freeBuilder(&b);
+                return false;
+            }
+        }
+    }
+
+    for (uint64_t v = 0; v < n; v++)
+        insertKey(b.heap, v, priority(&b, v), 0);
+
+    uint64_t order = 0;
+    HeapNode node;
+
+    while (extract_Min(b.heap, &node)) {
+        uint64_t v = node.id;
+        uint64_t current = b.priorities[v];
+
+        // Grown priorities are not moved down in the heap, so they are applied when popped
+        if (!isEmpty(b.heap) && current > b.heap->array[0].distance) {
+            insertKey(b.heap, v, current, 0);
+            continue;
+        }
+
+        uint64_t degree = b.adj[v].size;
+
+        if (!contract(&b, v)) {
+            freeBuilder(&b);
+            return false;
+        }
+
+        ch->rank[v] = order++;
+
+        for (uint64_t i = 0; i < degree; i++) {
+            uint64_t u = b.neighbours[i];
+            uint64_t updated = priority(&b, u);
+
+            if (isInHeap(b.heap, u) && updated < b.heap->array[b.heap->pos[u]].distance)
+                decreaseKey(b.heap, u, updated, 0);
+        }
+    }
+
+    if (!storeUpwardGraph(ch, &b)) {
+        freeBuilder(&b);
+        return false;
+    }
+
+    freeBuilder(&b);
+    ch->nVertices = n;
+    ch->valid = true;
+
+    return true;
+}
+
+void ContractionHierarchy_invalidate(ContractionHierarchy *ch) {
+    if (ch->valid) {
+        ch->valid = false;
+        ch->staleQueries = 0;
+    }
+}
+
+uint64_t ContractionHierarchy_middle(const ContractionHierarchy *ch, uint64_t u, uint64_t v) {
+    uint64_t low = ch->rank[u] < ch->rank[v] ? u : v;
+    uint64_t high = low == u ? v : u;
+
+    for (uint64_t e = ch->offsets[low]; e < ch->offsets[low + 1]; e++) {
+        if (ch->targets[e] == high)
+            return ch->middles[e];
+    }
+
+    return HIERARCHY_NO_MIDDLE;
+}
+
+void ContractionHierarchy_free(ContractionHierarchy *ch) {
+    free(ch->rank);
+    free(ch->offsets);
+    free(ch->targets);
+    free(ch->lengths);
+    free(ch->paths);
+    free(ch->middles);
+    free(ch);
+}
@@ -0,0 +1,83 @@
+/** @file
+ * Class interface storing a contraction hierarchy of the road graph.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_CONTRACTIONHIERARCHY_H
+#define GRAPHS_CONTRACTIONHIERARCHY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CsrGraph.h"
+
+/**
+ * Middle city of an edge which is an original road.
+ */
+#define HIERARCHY_NO_MIDDLE UINT64_MAX
+
+/**
+ * @brief Structure storing the upward graph of a contraction hierarchy.
+ * Cities are contracted one by one. Contracting a city adds a shortcut
+ * between every two of its remaining neighbours unless a strictly shorter
+ * path avoids it, so equal length paths keep their shortcuts and every
+ * shortest path of the map is exactly one up-down path of the hierarchy.
+ * Each edge knows how many shortest paths it stands for, which lets
+ * the queries detect ambiguous routes like the plain searches do.
+ * Edges are stored only at their lower ranked end, in the compressed
+ * sparse row layout of CsrGraph.
+ */
+typedef struct ContractionHierarchy {
+    uint64_t nVertices; /**< Number of cities in the hierarchy. */
+    uint64_t *rank; /**< Position of the city in the contraction order. */
+    uint64_t *offsets; /**< Upward edges of city v are at indices offsets[v] .. offsets[v + 1] - 1. */
+    uint64_t *targets; /**< Higher ranked end of each edge. */
+    uint64_t *lengths; /**< Length of each edge. */
+    uint8_t *paths; /**< Number of shortest paths an edge stands for, 2 stands for two or more. */
+    uint64_t *middles; /**< City contracted when a shortcut was added, HIERARCHY_NO_MIDDLE for a road. */
+    bool requested; /**< Whether the queries should use the hierarchy. */
+    bool valid; /**< Whether the hierarchy reflects the current roads. */
+    unsigned staleQueries; /**< Number of queries answered without the hierarchy since it became outdated. */
+} ContractionHierarchy;
+
+/**
+ * @brief Creates an empty, invalid hierarchy.
+ * @return pointer on the created hierarchy, or NULL if memory allocation failed.
+ */
+ContractionHierarchy *ContractionHierarchy_create(void);
+
+/**
+ * @brief Contracts all cities of the snapshot.
+ * Cities are contracted in the order of the smallest edge difference,
+ * updated lazily, with the number of contracted neighbours as a penalty.
+ * @param[in, out] ch  - pointer on the hierarchy;
+ * @param[in] graph    - valid snapshot of the roads.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool ContractionHierarchy_build(ContractionHierarchy *ch, CsrGraph *graph);
+
+/**
+ * @brief Marks the hierarchy as outdated after a road was added or removed.
+ * Repairs do not change lengths, so they keep the hierarchy valid.
+ * @param[in, out] ch - pointer on the hierarchy.
+ */
+void ContractionHierarchy_invalidate(ContractionHierarchy *ch);
+
+/**
+ * @brief Gives the city a shortcut between two cities was added for.
+ * @param[in] ch - pointer on a valid hierarchy;
+ * @param[in] u  - id of a city;
+ * @param[in] v  - id of the other city, connected with u by an edge.
+ * @return id of the middle city, HIERARCHY_NO_MIDDLE if the edge is a road.
+ */
+uint64_t ContractionHierarchy_middle(const ContractionHierarchy *ch, uint64_t u, uint64_t v);
+
+/**
+ * @brief Frees the hierarchy to prevent memory leaks.
+ * @param[in, out] ch - pointer on the hierarchy.
+ */
+void ContractionHierarchy_free(ContractionHierarchy *ch);
+
+#endif //GRAPHS_CONTRACTIONHIERARCHY_H
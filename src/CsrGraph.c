@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "CsrGraph.h"
+
+CsrGraph *CsrGraph_create(void) {
+    CsrGraph *graph = (CsrGraph *) malloc(sizeof(CsrGraph));
+
+    if (graph == NULL)
+        return NULL;
+
+    graph->nVertices = 0;
+    graph->nEdges = 0;
+    graph->vertexCapacity = 0;
+    graph->edgeCapacity = 0;
+    graph->offsets = NULL;
+    graph->targets = NULL;
+    graph->lengths = NULL;
+    graph->years = NULL;
+    graph->valid = false;
+
+    return graph;
+}
+
+static bool reserveVertices(CsrGraph *graph, uint64_t nVertices) {
+    if (nVertices <= graph->vertexCapacity && graph->offsets != NULL)
+        return true;
+
+    uint64_t capacity = graph->vertexCapacity == 0 ? 1024 : graph->vertexCapacity;
+    while (capacity < nVertices)
+        capacity *= 2;
+
+    uint64_t *offsets = (uint64_t *) realloc(graph->offsets, (capacity + 1) * sizeof(uint64_t));
+    if (offsets == NULL)
+        return false;
+
+    graph->offsets = offsets;
+    graph->vertexCapacity = capacity;
+
+    return true;
+}
+
+static bool reserveEdges(CsrGraph *graph, uint64_t nEdges) {
+    if (nEdges <= graph->edgeCapacity && graph->targets != NULL)
+        return true;
+
+    uint64_t capacity = graph->edgeCapacity == 0 ? 4096 : graph->edgeCapacity;
+    while (capacity < nEdges)
+        capacity *= 2;
+
+    uint64_t *targets = (uint64_t *) realloc(graph->targets, capacity * sizeof(uint64_t));
+    if (targets == NULL)
+        return false;
+    graph->targets = targets;
+
+    unsigned *lengths = (unsigned *) realloc(graph->lengths, capacity * sizeof(unsigned));
+    if (lengths == NULL)
+        return false;
+    graph->lengths = lengths;
+
+    int *years = (int *) realloc(graph->years, capacity * sizeof(int));
+    if (years == NULL)
+        return false;
+    graph->years = years;
+
+    graph->edgeCapacity = capacity;
+
+    return true;
+}
+
+bool CsrGraph_rebuild(CsrGraph *graph, City **cities, uint64_t nCities) {
+    graph->valid = false;
+
+    if (!reserveVertices(graph, nCities))
+        return false;
+
+    // First pass counts the roads to lay out the rows
+    uint64_t nEdges = 0;
+    for (uint64_t v = 0; v < nCities; v++) {
+        graph->offsets[v] = nEdges;
+
+        for (Road *road = cities[v]->roadsList->head; road != NULL; road = road->nextRoadOfCity)
+            nEdges++;
+    }
+    graph->offsets[nCities] = nEdges;
+
+    if (!reserveEdges(graph, nEdges))
+        return false;
+
+    // Second pass copies the roads keeping the order of the adjacency lists
+    uint64_t e = 0;
+    for (uint64_t v = 0; v < nCities; v++) {
+        for (Road *road = cities[v]->roadsList->head; road != NULL; road = road->nextRoadOfCity) {
+            graph->targets[e] = road->adjCity->id;
+            graph->lengths[e] = road->length;
+            graph->years[e] = road->builtYear;
+            e++;
+        }
+    }
+
+    graph->nVertices = nCities;
+    graph->nEdges = nEdges;
+    graph->valid = true;
+
+    return true;
+}
+
+void CsrGraph_invalidate(CsrGraph *graph) {
+    graph->valid = false;
+}
+
+void CsrGraph_setYear(CsrGraph *graph, uint64_t u, uint64_t v, int year) {
+    if (!graph->valid)
+        return;
+
+    for (uint64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+        if (graph->targets[e] == v) {
+            graph->years[e] = year;
+            return;
+        }
+    }
+}
+
+void CsrGraph_free(CsrGraph *graph) {
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->lengths);
+    free(graph->years);
+    free(graph);
+}
@@ -0,0 +1,71 @@
+/** @file
+ * Class interface storing a compressed sparse row view of the road graph.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_CSRGRAPH_H
+#define GRAPHS_CSRGRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CityRoad.h"
+
+/**
+ * @brief Structure storing the roads of all cities in contiguous arrays.
+ * Roads of the city with id v are stored at indices
+ * offsets[v] .. offsets[v + 1] - 1 of the targets, lengths and years arrays,
+ * in the same order as in the roadsList of the city.
+ */
+typedef struct CsrGraph {
+    uint64_t nVertices; /**< Number of cities in the snapshot. */
+    uint64_t nEdges; /**< Number of directed roads in the snapshot. */
+    uint64_t vertexCapacity; /**< Allocated size of the offsets array minus one. */
+    uint64_t edgeCapacity; /**< Allocated size of the edge arrays. */
+    uint64_t *offsets; /**< Start index of the roads of each city. */
+    uint64_t *targets; /**< Id of the adjacent city of each road. */
+    unsigned *lengths; /**< Length of each road. */
+    int *years; /**< Built year or the year of the last repair of each road. */
+    bool valid; /**< Whether the snapshot reflects the current roads. */
+} CsrGraph;
+
+/**
+ * @brief Creates an empty, invalid snapshot.
+ * @return pointer on the created snapshot, or NULL if memory allocation failed.
+ */
+CsrGraph *CsrGraph_create(void);
+
+/**
+ * @brief Rebuilds the snapshot from the adjacency lists of the cities.
+ * @param[in, out] graph - pointer on the snapshot;
+ * @param[in] cities     - array of cities indexed by id;
+ * @param[in] nCities    - number of cities in the array.
+ * @return @p true if the snapshot was rebuilt, @p false if memory allocation failed.
+ */
+bool CsrGraph_rebuild(CsrGraph *graph, City **cities, uint64_t nCities);
+
+/**
+ * @brief Marks the snapshot as outdated, so it is rebuilt before the next use.
+ * @param[in, out] graph - pointer on the snapshot.
+ */
+void CsrGraph_invalidate(CsrGraph *graph);
+
+/**
+ * @brief Updates the year of the road from city u to city v in place.
+ * Does nothing if the snapshot is outdated.
+ * @param[in, out] graph - pointer on the snapshot;
+ * @param[in] u          - id of the city the road starts in;
+ * @param[in] v          - id of the adjacent city;
+ * @param[in] year       - new year of the road.
+ */
+void CsrGraph_setYear(CsrGraph *graph, uint64_t u, uint64_t v, int year);
+
+/**
+ * @brief Frees the snapshot to prevent memory leaks.
+ * @param[in, out] graph - pointer on the snapshot.
+ */
+void CsrGraph_free(CsrGraph *graph);
+
+#endif //GRAPHS_CSRGRAPH_H
@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "EdgeIndex.h"
+
+typedef struct EdgeIndex_slot {
+    uint64_t u;
+    uint64_t v;
+    Road *road; /* NULL marks an empty slot */
+} EdgeSlot;
+
+struct EdgeIndex {
+    EdgeSlot *slots;
+    uint64_t mask;
+    uint64_t count;
+};
+
+static inline uint64_t hashPair(uint64_t u, uint64_t v) {
+    uint64_t h = u * 0x9E3779B97F4A7C15ULL ^ v;
+
+    // Finalizer of splitmix64
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+
+    return h;
+}
+
+EdgeIndex *EdgeIndex_create(uint64_t capacity) {
+    EdgeIndex *index = (EdgeIndex *) malloc(sizeof(EdgeIndex));
+    if (index == NULL)
+        return NULL;
+
+    uint64_t size = 16;
+    while (size < capacity)
+        size *= 2;
+
+    index->slots = (EdgeSlot *) calloc(size, sizeof(EdgeSlot));
+    if (index->slots == NULL) {
+        free(index);
+        return NULL;
+    }
+
+    index->mask = size - 1;
+    index->count = 0;
+
+    return index;
+}
+
+Road *EdgeIndex_find(EdgeIndex *index, uint64_t u, uint64_t v) {
+    uint64_t i = hashPair(u, v) & index->mask;
+
+    while (index->slots[i].road != NULL) {
+        if (index->slots[i].u == u && index->slots[i].v == v)
+            return index->slots[i].road;
+
+        i = (i + 1) & index->mask;
+    }
+
+    return NULL;
+}
+
+static void placeSlot(EdgeSlot *slots, uint64_t mask, uint64_t u, uint64_t v, Road *road) {
+    uint64_t i = hashPair(u, v) & mask;
+
+    while (slots[i].road != NULL)
+        i = (i + 1) & mask;
+
+    slots[i].u = u;
+    slots[i].v = v;
+    slots[i].road = road;
+}
+
+static bool grow(EdgeIndex *index) {
+    uint64_t size = 2 * (index->mask + 1);
+    EdgeSlot *slots = (EdgeSlot *) calloc(size, sizeof(EdgeSlot));
+
+    if (slots == NULL)
+        return false;
+
+    for (uint64_t i = 0; i <= index->mask; i++) {
+        EdgeSlot *slot = &index->slots[i];
+
+        if (slot->road != NULL)
+            placeSlot(slots, size - 1, slot->u, slot->v, slot->road);
+    }
+
+    free(index->slots);
+    index->slots = slots;
+    index->mask = size - 1;
+
+    return true;
+}
+
+bool EdgeIndex_insert(EdgeIndex *index, uint64_t u, uint64_t v, Road *road) {
+    // Keep the load factor under 50% so probe sequences stay short
+    if (2 * (index->count + 1) > index->mask + 1 && !grow(index))
+        return false;
+
+    uint64_t i = hashPair(u, v) & index->mask;
+
+    while (index->slots[i].road != NULL) {
+        if (index->slots[i].u == u && index->slots[i].v == v) {
+            index->slots[i].road = road;
+            return true;
+        }
+
+        i = (i + 1) & index->mask;
+    }
+
+    index->slots[i].u = u;
+    index->slots[i].v = v;
+    index->slots[i].road = road;
+    index->count++;
+
+    return true;
+}
+
+void EdgeIndex_remove(EdgeIndex *index, uint64_t u, uint64_t v) {
+    uint64_t mask = index->mask;
+    uint64_t i = hashPair(u, v) & mask;
+
+    while (index->slots[i].road != NULL) {
+        if (index->slots[i].u == u && index->slots[i].v == v)
+            break;
+
+        i = (i + 1) & mask;
+    }
+
+    if (index->slots[i].road == NULL)
+        return;
+
+    // Backward shift deletion: move up every following slot whose
+    // probe sequence passes through the freed one
+    uint64_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+
+        if (index->slots[j].road == NULL)
+            break;
+
+        uint64_t home = hashPair(index->slots[j].u, index->slots[j].v) & mask;
+
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+
+    index->slots[i].road = NULL;
+    index->count--;
+}
+
+void EdgeIndex_free(EdgeIndex *index) {
+    free(index->slots);
+    free(index);
+}
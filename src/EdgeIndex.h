@@ -0,0 +1,59 @@
+/** @file
+ * Class interface storing a hash index of roads keyed by pairs of city ids.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_EDGEINDEX_H
+#define GRAPHS_EDGEINDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CityRoad.h"
+
+/**
+ * @brief Creates an empty index of roads.
+ * @param[in] capacity - initial number of slots, rounded up to a power of two.
+ * @return pointer on the created index, or NULL if memory allocation failed.
+ */
+EdgeIndex *EdgeIndex_create(uint64_t capacity);
+
+/**
+ * @brief Searches for the road from city u to city v.
+ * @param[in] index - pointer on the index;
+ * @param[in] u     - id of the city the road starts in;
+ * @param[in] v     - id of the adjacent city.
+ * @return pointer on the road if it exists, otherwise NULL.
+ */
+Road *EdgeIndex_find(EdgeIndex *index, uint64_t u, uint64_t v);
+
+/**
+ * @brief Inserts the road from city u to city v.
+ * If the index is filled in more than a half, then it is enlarged.
+ * @param[in, out] index - pointer on the index;
+ * @param[in] u          - id of the city the road starts in;
+ * @param[in] v          - id of the adjacent city;
+ * @param[in] road       - pointer on the road from u to v.
+ * @return @p true if the road was inserted, @p false if memory allocation failed.
+ */
+bool EdgeIndex_insert(EdgeIndex *index, uint64_t u, uint64_t v, Road *road);
+
+/**
+ * @brief Removes the road from city u to city v.
+ * Does nothing if there is no such road in the index.
+ * @param[in, out] index - pointer on the index;
+ * @param[in] u          - id of the city the road starts in;
+ * @param[in] v          - id of the adjacent city.
+ */
+void EdgeIndex_remove(EdgeIndex *index, uint64_t u, uint64_t v);
+
+/**
+ * @brief Frees the index to prevent memory leaks.
+ * Roads stored in the index are not freed.
+ * @param[in, out] index - pointer on the index.
+ */
+void EdgeIndex_free(EdgeIndex *index);
+
+#endif //GRAPHS_EDGEINDEX_H
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Fields.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FIELDS_VECTOR 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FIELDS_VECTOR 16
+#endif
+
+#define FIELDS_SIZE 8
+
+void Fields_init(Fields *fields) {
+    fields->items = NULL;
+    fields->count = 0;
+    fields->capacity = 0;
+    fields->valid = true;
+}
+
+static inline bool isControl(char c) {
+    return (unsigned char) c < 32;
+}
+
+/* Ends the current field at index end of the line */
+static inline bool addField(Fields *fields, char *line, size_t start, size_t end) {
+    if (fields->count == fields->capacity) {
+        size_t capacity = fields->capacity > 0 ? 2 * fields->capacity : FIELDS_SIZE;
+        Field *items = (Field *) realloc(fields->items, capacity * sizeof(Field));
+
+        if (items == NULL)
+            return false;
+
+        fields->items = items;
+        fields->capacity = capacity;
+    }
+
+    line[end] = '\0';
+    fields->items[fields->count++] = (Field) {line + start, end - start};
+
+    return true;
+}
+
+/* Splits the line from index i on, where the current field starts at index start */
+static bool splitFrom(Fields *fields, char *line, size_t length, size_t i, size_t start) {
+    for (; i < length; i++) {
+        if (isControl(line[i])) {
+            fields->valid = false;
+            return true;
+        }
+
+        if (line[i] == ';') {
+            if (!addField(fields, line, start, i))
+                return false;
+
+            start = i + 1;
+        }
+    }
+
+    // The last field ends at the terminator of the line
+    return addField(fields, line, start, length);
+}
+
+bool Fields_splitScalar(Fields *fields, char *line, size_t length) {
+    fields->count = 0;
+    fields->valid = true;
+
+    return splitFrom(fields, line, length, 0, 0);
+}
+
+#ifdef FIELDS_VECTOR
+
+/* Masks of the semicolons and of the control characters among the bytes at chars */
+static inline void scanVector(const char *chars, uint32_t *semicolons, uint32_t *controls) {
+#if defined(__AVX2__)
+    __m256i bytes = _mm256_loadu_si256((const __m256i *) chars);
+
+    // A byte is at most 31 exactly when the unsigned minimum with 31 leaves it unchanged
+    __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, _mm256_set1_epi8(31)), bytes);
+    *semicolons = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(';')));
+    *controls = (uint32_t) _mm256_movemask_epi8(low);
+#else
+    __m128i bytes = _mm_loadu_si128((const __m128i *) chars);
+
+    // A byte is at most 31 exactly when the unsigned minimum with 31 leaves it unchanged
+    __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(31)), bytes);
+    *semicolons = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(';')));
+    *controls = (uint32_t) _mm_movemask_epi8(low);
+#endif
+}
+
+bool Fields_split(Fields *fields, char *line, size_t length) {
+    fields->count = 0;
+    fields->valid = true;
+
+    size_t start = 0;
+    size_t i = 0;
+
+    for (; i + FIELDS_VECTOR <= length; i += FIELDS_VECTOR) {
+        uint32_t semicolons;
+        uint32_t controls;
+        scanVector(line + i, &semicolons, &controls);
+
+        if (controls != 0) {
+            fields->valid = false;
+            return true;
+        }
+
+        // Every set bit ends a field
+        while (semicolons != 0) {
+            size_t end = i + __builtin_ctz(semicolons);
+
+            if (!addField(fields, line, start, end))
+                return false;
+
+            start = end + 1;
+            semicolons &= semicolons - 1;
+        }
+    }
+
+    return splitFrom(fields, line, length, i, start);
+}
+
+bool Fields_isName(const char *chars, size_t length) {
+    size_t i = 0;
+
+    for (; i + FIELDS_VECTOR <= length; i += FIELDS_VECTOR) {
+        uint32_t semicolons;
+        uint32_t controls;
+        scanVector(chars + i, &semicolons, &controls);
+
+        if ((semicolons | controls) != 0)
+            return false;
+    }
+
+    for (; i < length; i++) {
+        if (isControl(chars[i]) || chars[i] == ';')
+            return false;
+    }
+
+    return length > 0;
+}
+
+#else
+
+bool Fields_split(Fields *fields, char *line, size_t length) {
+    return Fields_splitScalar(fields, line, length);
+}
+
+bool Fields_isName(const char *chars, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (isControl(chars[i]) || chars[i] == ';')
+            return false;
+    }
+
+    return length > 0;
+}
+
+#endif
+
+void Fields_free(Fields *fields) {
+    free(fields->items);
+    Fields_init(fields);
+}
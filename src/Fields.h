@@ -0,0 +1,80 @@
+/** @file
+ * Class interface storing the fields of a command line.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_FIELDS_H
+#define GRAPHS_FIELDS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief Structure storing a part of a line between semicolons.
+ * The characters stay in the line, the semicolon behind them is
+ * overwritten with a terminator.
+ */
+typedef struct Field {
+    char *chars; /**< First character of the field. */
+    size_t length; /**< Number of characters of the field. */
+} Field;
+
+/**
+ * @brief Structure storing the fields of a line.
+ * The array is reused by the following lines, so splitting a line
+ * allocates only when it has more fields than any line before.
+ */
+typedef struct Fields {
+    Field *items; /**< Fields in the order of the line. */
+    size_t count; /**< Number of fields of the line. */
+    size_t capacity; /**< Number of fields the array can hold. */
+    bool valid; /**< Whether the line has no characters with codes 0 .. 31. */
+} Fields;
+
+/**
+ * @brief Initialises an empty array of fields.
+ * @param[out] fields - pointer on the fields.
+ */
+void Fields_init(Fields *fields);
+
+/**
+ * @brief Splits the line on semicolons and checks its characters in the same pass.
+ * Compiled with SSE2 or AVX2 the line is scanned 16 or 32 bytes at a time.
+ * A line with a character of code 0 .. 31 is not split, only marked as invalid,
+ * as such a character cannot be a part of any command.
+ * @param[in, out] fields - pointer on the fields;
+ * @param[in, out] line   - the line, its semicolons are overwritten with terminators;
+ * @param[in] length      - number of characters of the line.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool Fields_split(Fields *fields, char *line, size_t length);
+
+/**
+ * @brief Splits the line like @ref Fields_split, one byte at a time.
+ * It is the fallback of the vectorised version, kept callable for comparing both.
+ * @param[in, out] fields - pointer on the fields;
+ * @param[in, out] line   - the line, its semicolons are overwritten with terminators;
+ * @param[in] length      - number of characters of the line.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool Fields_splitScalar(Fields *fields, char *line, size_t length);
+
+/**
+ * @brief Checks whether the characters can form a name of a city.
+ * A name is not empty and has neither semicolons nor characters of code 0 .. 31.
+ * @param[in] chars  - characters of the name;
+ * @param[in] length - number of characters.
+ * @return @p true if the name is correct, @p false otherwise.
+ */
+bool Fields_isName(const char *chars, size_t length);
+
+/**
+ * @brief Frees the array of fields, the lines are not touched.
+ * @param[in, out] fields - pointer on the fields.
+ */
+void Fields_free(Fields *fields);
+
+#endif //GRAPHS_FIELDS_H
@@ -1,124 +1,253 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include "HashMap.h"
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define GROUP_WIDTH 16
+#define CTRL_EMPTY ((int8_t) -128)
+
 struct HashMap_item {
-    hm_item *next;
-    void *key;
+    Name *key;
     void *value;
 };
 
+/*
+ * Swiss table: every slot has a control byte which is either CTRL_EMPTY or
+ * the low 7 bits of the hash of the key stored in the slot. Lookups compare
+ * a whole group of control bytes at once and touch only the slots whose
+ * control byte matches. The first GROUP_WIDTH control bytes are mirrored
+ * after the last one, so a group read never needs to wrap around.
+ */
 struct HashMap {
-    hm_item **buckets;
-    uint64_t size;
+    int8_t *ctrl;
+    hm_item *slots;
+    uint64_t mask;
     uint64_t count;
+    uint64_t growthLeft;
 };
 
-static hm_item *create_item(void *key, void *value) {
-    hm_item *item = (hm_item *) malloc(sizeof(hm_item));
-    char *key_str = key;
-    char *keycopy = malloc(strlen(key_str) + 1);
-    strcpy(keycopy, key_str);
-    item->key = keycopy;
-    item->value = value;
+static inline uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+static inline uint64_t h1(uint64_t hash) {
+    return hash >> 7;
+}
+
+static inline int8_t h2(uint64_t hash) {
+    return (int8_t) (hash & 0x7F);
+}
+
+static inline unsigned lowestBit(uint32_t bits) {
+#if defined(__GNUC__)
+    return (unsigned) __builtin_ctz(bits);
+#else
+    unsigned i = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+#ifdef __SSE2__
+
+static inline uint32_t matchByte(const int8_t *group, int8_t byte) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte)));
+}
+
+#else
+
+static inline uint32_t matchByte(const int8_t *group, int8_t byte) {
+    uint32_t bits = 0;
+
+    for (unsigned i = 0; i < GROUP_WIDTH; i++) {
+        if (group[i] == byte)
+            bits |= 1u << i;
+    }
+
+    return bits;
+}
+
+#endif
 
-    return item;
+static inline uint64_t capacityFor(uint64_t size) {
+    uint64_t capacity = GROUP_WIDTH;
+
+    while (capacity < size)
+        capacity *= 2;
+
+    return capacity;
 }
 
-static uint64_t hash(const char *ptr, uint64_t size) {
-    uint64_t hash = 5381;
-    uint64_t c;
+static bool initTable(hmap *hm, uint64_t capacity) {
+    hm->ctrl = (int8_t *) malloc((capacity + GROUP_WIDTH) * sizeof(int8_t));
+    hm->slots = (hm_item *) malloc(capacity * sizeof(hm_item));
+
+    if (hm->ctrl == NULL || hm->slots == NULL) {
+        free(hm->ctrl);
+        free(hm->slots);
+        return false;
+    }
 
-    while ((c = *ptr++))
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+    memset(hm->ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+    hm->mask = capacity - 1;
+    hm->growthLeft = capacity - capacity / 8;
 
-    return hash % size;
+    return true;
 }
 
 hmap *create_hmap(uint64_t size) {
     hmap *hm = (hmap *) malloc(sizeof(hmap));
-    hm->buckets = calloc(size, sizeof(hm_item *));
-    hm->size = size;
+
+    if (hm == NULL)
+        return NULL;
+
+    if (!initTable(hm, capacityFor(size))) {
+        free(hm);
+        return NULL;
+    }
+
     hm->count = 0;
 
     return hm;
 }
 
-void *search_hmap(hmap *hm, char *key) {
-    int index = hash(key, hm->size);
-
-    hm_item *item = hm->buckets[index];
-    while (item != NULL) {
-        char *item_key = (char *) item->key;
-        int kmp = strcmp(key, item_key);
-        if (kmp == 0) {
-            return item->value;
-        }
-        item = item->next;
-    }
+static inline void setCtrl(hmap *hm, uint64_t i, int8_t byte) {
+    hm->ctrl[i] = byte;
+
+    // Keep the mirrored copy of the first group in sync
+    if (i < GROUP_WIDTH)
+        hm->ctrl[hm->mask + 1 + i] = byte;
+}
+
+static inline uint64_t findEmpty(hmap *hm, uint64_t hash) {
+    uint64_t pos = h1(hash) & hm->mask;
+    uint64_t stride = 0;
 
-    return NULL;
+    while (true) {
+        uint32_t empty = matchByte(hm->ctrl + pos, CTRL_EMPTY);
+
+        if (empty != 0)
+            return (pos + lowestBit(empty)) & hm->mask;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & hm->mask;
+    }
 }
 
-void rehash(hmap *hm) {
-    hm_item *next;
+static hm_item *find(hmap *hm, const char *key, uint64_t length, uint64_t hash) {
+    uint64_t mixed = mixHash(hash);
+    int8_t tag = h2(mixed);
+    uint64_t pos = h1(mixed) & hm->mask;
+    uint64_t stride = 0;
+
+#if defined(__GNUC__)
+    // The key is usually in one of the first slots of the probe sequence, so
+    // fetch them in parallel with the control bytes instead of after them
+    __builtin_prefetch(&hm->slots[pos]);
+#endif
 
-    hm_item **current = hm->buckets;
-    uint64_t s = hm->size;
-    uint64_t size = s * 2;
+    while (true) {
+        const int8_t *group = hm->ctrl + pos;
 
-    hm_item **buckets = calloc(size, sizeof(hm_item *));
+        for (uint32_t bits = matchByte(group, tag); bits != 0; bits &= bits - 1) {
+            hm_item *item = &hm->slots[(pos + lowestBit(bits)) & hm->mask];
 
-    for (uint64_t i = 0; i < s; i++) {
-        for (hm_item *item = current[i]; item != NULL; item = next) {
-            uint64_t index = hash(item->key, size);
-            next = item->next;
-            item->next = buckets[index];
-            buckets[index] = item;
+            if (Name_equals(item->key, key, length, hash))
+                return item;
         }
+
+        // An empty slot in the group ends the probe sequence
+        if (matchByte(group, CTRL_EMPTY) != 0)
+            return NULL;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & hm->mask;
     }
+}
 
-    free(hm->buckets);
-    hm->buckets = buckets;
-    hm->size = size;
+void *search_hmap(hmap *hm, char *key) {
+    uint64_t length = strlen(key);
+    hm_item *item = find(hm, key, length, Name_hash(key, length));
+
+    return item == NULL ? NULL : item->value;
 }
 
+void *search_hmap_key(hmap *hm, const NameKey *key) {
+    hm_item *item = find(hm, key->chars, key->length, key->hash);
 
-void set_hmap(hmap *hm, void *key, void *value) {
-    hm_item *item;
-    uint64_t index = hash(key, hm->size);
+    return item == NULL ? NULL : item->value;
+}
 
-    hm_item **p = &(hm->buckets[index]);
+/* Doubles the table. If memory allocation fails, the old table is kept unchanged. */
+static bool rehash(hmap *hm) {
+    int8_t *ctrl = hm->ctrl;
+    hm_item *slots = hm->slots;
+    uint64_t capacity = hm->mask + 1;
 
-    for (item = *p; item != NULL; item = item->next) {
-        char *item_key = (char *) item->key;
-        int kmp = strcmp(key, item_key);
-        if (kmp == 0) {            // key already exists
-            item->value = value;
-            return;
+    if (!initTable(hm, 2 * capacity)) {
+        hm->ctrl = ctrl;
+        hm->slots = slots;
+        return false;
+    }
+
+    for (uint64_t i = 0; i < capacity; i++) {
+        if (ctrl[i] != CTRL_EMPTY) {
+            // Names keep their hash, so strings are not hashed again
+            uint64_t mixed = mixHash(slots[i].key->hash);
+            uint64_t j = findEmpty(hm, mixed);
+            setCtrl(hm, j, h2(mixed));
+            hm->slots[j] = slots[i];
         }
     }
 
-    item = *p;
-    (*p) = create_item(key, value);
-    (*p)->next = item;
+    hm->growthLeft -= hm->count;
+    free(ctrl);
+    free(slots);
 
-    // Rehash when current size is at least 75% of the total size
-    if (++hm->count >= hm->size * 3 / 4)
-        rehash(hm);
+    return true;
 }
 
-void free_hmap(hmap *hm) {
-    for (uint64_t i = 0; i < hm->size; i++) {
-        for (hm_item *item = hm->buckets[i]; item != NULL;) {
-            hm_item *next = item->next;
-            free(item->key);
-            free(item);
-            item = next;
-        }
+bool set_hmap(hmap *hm, Name *key, void *value) {
+    hm_item *item = find(hm, key->chars, key->length, key->hash);
+
+    if (item != NULL) { // key already exists
+        item->value = value;
+        return true;
     }
 
-    free(hm->buckets);
+    // Rehash when the table would be filled in more than 7/8. Without a bigger
+    // table the old one is filled up to 7/8, so every probe still meets an empty slot.
+    if (hm->growthLeft <= 1 && !rehash(hm) && hm->growthLeft == 0)
+        return false;
+
+    uint64_t mixed = mixHash(key->hash);
+    uint64_t i = findEmpty(hm, mixed);
+    setCtrl(hm, i, h2(mixed));
+    hm->slots[i].key = key;
+    hm->slots[i].value = value;
+    hm->count++;
+    hm->growthLeft--;
+
+    return true;
+}
+
+void free_hmap(hmap *hm) {
+    free(hm->ctrl);
+    free(hm->slots);
     free(hm);
-}
\ No newline at end of file
+}
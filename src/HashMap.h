@@ -10,6 +10,8 @@
 #define HASHMAP_HASHMAP_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "NameArena.h"
 
 /**
  * Structure storing HashMap item.
@@ -23,7 +25,8 @@ typedef struct HashMap hmap;
 
 /**
  * @brief Creates HasMap.
- * @param[in] size - size of the array for storing hm_items .
+ * HashMap is an open addressing table probed a group of slots at a time.
+ * @param[in] size - size of the array for storing hm_items, rounded up to a power of two.
  * @return pointer on the HashMap, or NULL if memory allocation failed.
  */
 hmap *create_hmap(uint64_t size);
@@ -36,15 +39,26 @@ hmap *create_hmap(uint64_t size);
  */
 void *search_hmap(hmap *hm, char *key);
 
+/**
+ * @brief Searches in HashMap for the name with a precomputed hash.
+ * @param[in] hm  - reference on HashMap;
+ * @param[in] key - key of the name of the city.
+ * @return pointer on the value if it exists for given key, otherwise NULL.
+ */
+void *search_hmap_key(hmap *hm, const NameKey *key);
+
 /**
  * @brief Set key-value pair in HashMap.
- * If the size of the buckets in HashMap is more than the 75% of the
- * HashMap size, then does a rehash.
+ * The key is not copied, HashMap keeps the reference on the interned name.
+ * If more than 7/8 of the slots of HashMap would be used, then does a rehash
+ * reusing the hashes stored in the names.
  * @param[in, out] hm - reference on HashMap;
- * @param[in] key     - key is the name of the city;
+ * @param[in] key     - key is the interned name of the city;
  * @param[in] value   - value is the reference on the City.
+ * @return @p true if the pair was set, @p false if the HashMap is full and
+ * memory allocation for a bigger one failed.
  */
-void set_hmap(hmap *hm, void *key, void *value);
+bool set_hmap(hmap *hm, Name *key, void *value);
 
 /**
  * @brief Frees the HashMap.
@@ -1,135 +1,147 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "Heap.h"
 
-HeapNode *HeapNode_create(uint64_t id, uint64_t distance, int year) {
-    HeapNode *heapNode = (HeapNode *) malloc(sizeof(HeapNode));
-    if (heapNode == NULL)
-        return NULL;
-
-    heapNode->id = id;
-    heapNode->distance = distance;
-    heapNode->year = year;
-
-    return heapNode;
-}
-
 Heap *Heap_create(uint64_t capacity) {
     Heap *heap = (Heap *) malloc(sizeof(Heap));
     if (heap == NULL)
         return NULL;
 
-    heap->pos = (uint64_t *) malloc(capacity * sizeof(uint64_t));
-    if (heap->pos == NULL)
+    // Positions of cities never inserted are read by isInHeap, so they start at 0
+    heap->pos = (uint64_t *) calloc(capacity, sizeof(uint64_t));
+    heap->array = (HeapNode *) malloc(capacity * sizeof(HeapNode));
+
+    if (heap->pos == NULL || heap->array == NULL) {
+        free(heap->pos);
+        free(heap->array);
+        free(heap);
         return NULL;
+    }
 
     heap->size = 0;
     heap->capacity = capacity;
-    heap->array = (HeapNode **) malloc(capacity * sizeof(HeapNode *));
 
     return heap;
 }
 
-static inline void swap_HeapNode(HeapNode **a, HeapNode **b) {
-    HeapNode *t = *a;
-    *a = *b;
-    *b = t;
+bool Heap_reserve(Heap *heap, uint64_t capacity) {
+    if (capacity <= heap->capacity)
+        return true;
+
+    uint64_t *pos = (uint64_t *) realloc(heap->pos, capacity * sizeof(uint64_t));
+    if (pos == NULL)
+        return false;
+    memset(pos + heap->capacity, 0, (capacity - heap->capacity) * sizeof(uint64_t));
+    heap->pos = pos;
+
+    HeapNode *array = (HeapNode *) realloc(heap->array, capacity * sizeof(HeapNode));
+    if (array == NULL)
+        return false;
+    heap->array = array;
+
+    heap->capacity = capacity;
+
+    return true;
+}
+
+void Heap_clear(Heap *heap) {
+    heap->size = 0;
 }
 
-static inline bool compareYears(int year1, int year2) {
-    return year1 < year2;
+/* Smaller distance first, on equal distance the older year first */
+static inline bool isLess(const HeapNode *a, const HeapNode *b) {
+    return a->distance < b->distance || (a->distance == b->distance && a->year < b->year);
 }
 
-static void minHeapify(Heap *heap, uint64_t idx) {
-    uint64_t smallest = idx;
-    uint64_t left = 2 * idx + 1;
-    uint64_t right = 2 * idx + 2;
+static inline void siftUp(Heap *heap, uint64_t i, HeapNode node) {
+    // Move parents down into the hole instead of swapping at every level
+    while (i > 0) {
+        uint64_t parent = (i - 1) / HEAP_ARITY;
 
-    if (left < heap->size &&
-        ((heap->array[left]->distance < heap->array[smallest]->distance) ||
-         ((heap->array[left]->distance == heap->array[smallest]->distance) &&
-          compareYears(heap->array[left]->year, heap->array[smallest]->year))))
-        smallest = left;
+        if (!isLess(&node, &heap->array[parent]))
+            break;
 
-    if (right < heap->size &&
-        ((heap->array[right]->distance < heap->array[smallest]->distance) ||
-         ((heap->array[right]->distance == heap->array[smallest]->distance) &&
-          compareYears(heap->array[right]->year, heap->array[smallest]->year))))
-        smallest = right;
+        heap->array[i] = heap->array[parent];
+        heap->pos[heap->array[i].id] = i;
+        i = parent;
+    }
+
+    heap->array[i] = node;
+    heap->pos[node.id] = i;
+}
+
+static inline void siftDown(Heap *heap, uint64_t i, HeapNode node) {
+    while (true) {
+        uint64_t first = HEAP_ARITY * i + 1;
 
-    if (smallest != idx) {
-        // The nodes to be swapped in min heap
-        HeapNode *smallestNode = heap->array[smallest];
-        HeapNode *idxNode = heap->array[idx];
+        if (first >= heap->size)
+            break;
 
-        // Swap positions
-        heap->pos[smallestNode->id] = idx;
-        heap->pos[idxNode->id] = smallest;
+        uint64_t last = first + HEAP_ARITY < heap->size ? first + HEAP_ARITY : heap->size;
+        uint64_t smallest = first;
 
-        // Swap nodes
-        swap_HeapNode(&heap->array[smallest], &heap->array[idx]);
+        for (uint64_t child = first + 1; child < last; child++) {
+            if (isLess(&heap->array[child], &heap->array[smallest]))
+                smallest = child;
+        }
 
-        minHeapify(heap, smallest);
+        if (!isLess(&heap->array[smallest], &node))
+            break;
+
+        heap->array[i] = heap->array[smallest];
+        heap->pos[heap->array[i].id] = i;
+        i = smallest;
     }
+
+    heap->array[i] = node;
+    heap->pos[node.id] = i;
+}
+
+void insertKey(Heap *heap, uint64_t id, uint64_t distance, int year) {
+    HeapNode node = {distance, year, id};
+
+    siftUp(heap, heap->size++, node);
 }
 
 bool isEmpty(Heap *heap) {
     return heap->size <= 0;
 }
 
-HeapNode *extract_Min(Heap *heap) {
+bool extract_Min(Heap *heap, HeapNode *min) {
     if (isEmpty(heap))
-        return NULL;
+        return false;
 
     // Store the root node
-    HeapNode *root = heap->array[0];
+    *min = heap->array[0];
 
-    // Replace root node with last node
-    HeapNode *lastNode = heap->array[heap->size - 1];
-    heap->array[0] = lastNode;
+    // Move the last node into the root and heapify
+    HeapNode lastNode = heap->array[--heap->size];
 
-    // Update position of last node
-    heap->pos[root->id] = heap->size - 1;
-    heap->pos[lastNode->id] = 0;
+    if (heap->size > 0)
+        siftDown(heap, 0, lastNode);
 
-    // Reduce heap size and heapify root
-    minHeapify(heap, 0);
-    --heap->size;
-
-    return root;
+    return true;
 }
 
 bool isInHeap(Heap *heap, uint64_t v) {
-    if (heap->pos[v] < heap->size)
-        return true;
-    return false;
+    uint64_t i = heap->pos[v];
+
+    return i < heap->size && heap->array[i].id == v;
 }
 
 void decreaseKey(Heap *heap, uint64_t id, uint64_t distance, int year) {
     uint64_t i = heap->pos[id];
-
-    // Get the node and update its dist value
-    heap->array[i]->distance = distance;
-    heap->array[i]->year = year;
+    HeapNode node = {distance, year, id};
 
     // Travel up while the complete tree is not heapified
-    while (i && ((heap->array[i]->distance < heap->array[(i - 1) / 2]->distance) ||
-                 (heap->array[i]->distance == heap->array[(i - 1) / 2]->distance &&
-                  compareYears(heap->array[i]->year, heap->array[(i - 1) / 2]->year)))) {
-        // Swap this node with its parent
-        heap->pos[heap->array[i]->id] = (i - 1) / 2;
-        heap->pos[heap->array[(i - 1) / 2]->id] = i;
-        swap_HeapNode(&heap->array[i], &heap->array[(i - 1) / 2]);
-
-        // move to parent index
-        i = (i - 1) / 2;
-    }
+    siftUp(heap, i, node);
 }
 
 void free_Heap(Heap *heap) {
     free(heap->pos);
     free(heap->array);
     free(heap);
-}
\ No newline at end of file
+}
@@ -10,36 +10,34 @@
 #define GRAPHS_HEAP_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Number of children of every node of the heap.
+ */
+#define HEAP_ARITY 4
 
 /**
  * @brief Structure storing min-heap node.
+ * Nodes are stored inline in the heap array, so the heap allocates nothing
+ * while a search runs.
  */
 typedef struct MinHeapNode {
-    uint64_t id; /**< Id for each node to extract min. */
     uint64_t distance; /**< Stores distance of the min-heap node. */
     int year; /**< Stores year of the min-heap node. */
+    uint64_t id; /**< Id for each node to extract min. */
 } HeapNode;
 
 /**
- * @brief Structure for min-heap array implementation.
+ * @brief Structure for indexed 4-ary min-heap array implementation.
  */
 typedef struct MinHeap {
     uint64_t size; /**< Stores the current size of the min-heap. */
     uint64_t capacity; /**< Stores the total capacity of the min-heap. */
-    uint64_t *pos; /**< Stores the positions of the nodes. */
-    HeapNode **array; /**< Stores the nodes for array implementation. */
+    uint64_t *pos; /**< Stores the positions of the nodes, valid only for nodes in the heap. */
+    HeapNode *array; /**< Stores the nodes for array implementation. */
 } Heap;
 
-/**
- * @brief Creates a heap node.
- * Creates a heap node with given id, distance and year.
- * @param[in] id       - id of the created node;
- * @param[in] distance - distance of the created node;
- * @param[in] year     - year of the created node.
- * @return a pointer on the created node, or NULL if malloc failed.
- */
-HeapNode *HeapNode_create(uint64_t id, uint64_t distance, int year);
-
 /**
  *  @brief Creates heap for implementing dijkstra algorithm.
  * @param[in] capacity - capacity of the heap(NUmber of vertices).
@@ -47,6 +45,31 @@ HeapNode *HeapNode_create(uint64_t id, uint64_t distance, int year);
  */
 Heap *Heap_create(uint64_t capacity);
 
+/**
+ * @brief Makes room for at least capacity nodes in the heap.
+ * @param[in, out] heap - pointer on the heap;
+ * @param[in] capacity  - required capacity.
+ * @return @p true on success, @p false if realloc failed.
+ */
+bool Heap_reserve(Heap *heap, uint64_t capacity);
+
+/**
+ * @brief Removes all nodes from the heap in O(1).
+ * @param[in, out] heap - pointer on the heap.
+ */
+void Heap_clear(Heap *heap);
+
+/**
+ * @brief Inserts a node into the heap.
+ * Lets dijkstra algorithm put vertices into the heap when they are reached
+ * for the first time instead of filling it with all vertices at the start.
+ * @param[in, out] heap - pointer on the heap;
+ * @param[in] id        - id of the node, smaller than the capacity, not in the heap;
+ * @param[in] distance  - distance of the node;
+ * @param[in] year      - year of the node.
+ */
+void insertKey(Heap *heap, uint64_t id, uint64_t distance, int year);
+
 /**
  * @brief Decrease key is used for dijkstra algorithm to decrease
  * the value of the root node.
@@ -69,11 +92,11 @@ bool isEmpty(Heap *heap);
  * @brief Extracts heap node with min distance and oldest year.
  * If heap is not empty then extracts the node with min distance
  * and with the oldest year.
- * @param[in, out] heap - pointer on the heap.
- * @return pointer on the heap node to be extracted or NULL if
- * heap is empty.
+ * @param[in, out] heap - pointer on the heap;
+ * @param[out] min      - the extracted node.
+ * @return @p true if a node was extracted, @p false if heap is empty.
  */
-HeapNode *extract_Min(Heap *heap);
+bool extract_Min(Heap *heap, HeapNode *min);
 
 /**
  * @brief Checks whether node with given id is in heap.
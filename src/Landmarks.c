@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include "Landmarks.h"
+
+#define INITIAL_CAPACITY 1024
+
+Landmarks *Landmarks_create(void) {
+    Landmarks *lm = (Landmarks *) malloc(sizeof(Landmarks));
+
+    if (lm == NULL)
+        return NULL;
+
+    lm->heap = Heap_create(INITIAL_CAPACITY);
+
+    if (lm->heap == NULL) {
+        free(lm);
+        return NULL;
+    }
+
+    lm->requested = 0;
+    lm->count = 0;
+    lm->nCities = 0;
+    lm->capacity = 0;
+    lm->ids = NULL;
+    lm->dist = NULL;
+    lm->valid = false;
+    lm->staleSearches = 0;
+
+    return lm;
+}
+
+/* Makes room for the rows of nCities cities, new rows are unreached */
+static bool reserveRows(Landmarks *lm, uint64_t nCities) {
+    if (nCities > lm->capacity) {
+        uint64_t capacity = lm->capacity == 0 ? INITIAL_CAPACITY : lm->capacity;
+        while (capacity < nCities)
+            capacity *= 2;
+
+        uint64_t *dist = (uint64_t *) realloc(lm->dist, capacity * lm->count * sizeof(uint64_t));
+        if (dist == NULL)
+            return false;
+
+        lm->dist = dist;
+        lm->capacity = capacity;
+    }
+
+    for (uint64_t i = lm->nCities * lm->count; i < nCities * lm->count; i++)
+        lm->dist[i] = LANDMARK_UNREACHED;
+
+    if (nCities > lm->nCities)
+        lm->nCities = nCities;
+
+    return true;
+}
+
+/* Plain dijkstra from src over all roads, no city excluded */
+static bool searchFrom(CsrGraph *graph, SearchWorkspace *ws, uint64_t nCities, uint64_t src) {
+    if (!SearchWorkspace_begin(ws, nCities))
+        return false;
+
+    if (!SearchWorkspace_relax(ws, src, 0, 0, 0, NULL))
+        return false;
+
+    uint64_t u;
+    while ((u = SearchWorkspace_extractMin(ws)) != UINT64_MAX) {
+        uint64_t distU = ws->dist[u];
+
+        for (uint64_t e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            uint64_t v = graph->targets[e];
+            uint64_t distV = distU + graph->lengths[e];
+
+            if (!SearchWorkspace_isSettled(ws, v) && distV < SearchWorkspace_dist(ws, v) &&
+                !SearchWorkspace_relax(ws, v, distV, distV, 0, NULL))
+                return false;
+        }
+    }
+
+    return !ws->failed;
+}
+
+bool Landmarks_build(Landmarks *lm, CsrGraph *graph, SearchWorkspace *ws, uint64_t nCities, unsigned count) {
+    lm->requested = count;
+    lm->valid = false;
+    lm->staleSearches = 0;
+    lm->count = 0;
+    lm->nCities = 0;
+
+    if (count == 0 || nCities == 0)
+        return true;
+
+    if (count > nCities)
+        count = (unsigned) nCities;
+
+    uint64_t *ids = (uint64_t *) realloc(lm->ids, count * sizeof(uint64_t));
+    if (ids == NULL)
+        return false;
+    lm->ids = ids;
+
+    // Rows are as wide as the number of landmarks, so the old table is useless
+    free(lm->dist);
+    lm->dist = NULL;
+    lm->capacity = 0;
+    lm->count = count;
+
+    uint64_t *closest = (uint64_t *) malloc(nCities * sizeof(uint64_t));
+
+    if (closest == NULL || !reserveRows(lm, nCities) || !searchFrom(graph, ws, nCities, 0)) {
+        free(closest);
+        return false;
+    }
+
+    // The first landmark is the city farthest from an arbitrary one
+    uint64_t next = 0;
+    for (uint64_t v = 0; v < nCities; v++) {
+        closest[v] = LANDMARK_UNREACHED;
+
+        if (SearchWorkspace_dist(ws, v) != UINT64_MAX && SearchWorkspace_dist(ws, v) > SearchWorkspace_dist(ws, next))
+            next = v;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        lm->ids[i] = next;
+        closest[next] = 0;
+
+        if (!searchFrom(graph, ws, nCities, next)) {
+            free(closest);
+            return false;
+        }
+
+        for (uint64_t v = 0; v < nCities; v++) {
+            uint64_t dist = SearchWorkspace_dist(ws, v);
+            lm->dist[v * count + i] = dist;
+
+            if (dist < closest[v])
+                closest[v] = dist;
+
+            // Cities not connected with any landmark yet are the farthest
+            if (closest[v] > closest[next])
+                next = v;
+        }
+    }
+
+    free(closest);
+    lm->valid = true;
+
+    return true;
+}
+
+void Landmarks_addRoad(Landmarks *lm, City **cities, uint64_t nCities, City *city1, City *city2, unsigned length) {
+    if (!lm->valid)
+        return;
+
+    if (!reserveRows(lm, nCities) || !Heap_reserve(lm->heap, nCities)) {
+        lm->valid = false;
+        return;
+    }
+
+    for (unsigned i = 0; i < lm->count; i++) {
+        uint64_t dist1 = lm->dist[city1->id * lm->count + i];
+        uint64_t dist2 = lm->dist[city2->id * lm->count + i];
+
+        Heap_clear(lm->heap);
+
+        // At most one end of the road gets closer to the landmark
+        if (dist1 != LANDMARK_UNREACHED && dist1 + length < dist2) {
+            lm->dist[city2->id * lm->count + i] = dist1 + length;
+            insertKey(lm->heap, city2->id, dist1 + length, 0);
+        } else if (dist2 != LANDMARK_UNREACHED && dist2 + length < dist1) {
+            lm->dist[city1->id * lm->count + i] = dist2 + length;
+            insertKey(lm->heap, city1->id, dist2 + length, 0);
+        }
+
+        HeapNode node;
+        while (extract_Min(lm->heap, &node)) {
+            for (Road *road = cities[node.id]->roadsList->head; road != NULL; road = road->nextRoadOfCity) {
+                uint64_t v = road->adjCity->id;
+                uint64_t dist = node.distance + road->length;
+
+                if (dist < lm->dist[v * lm->count + i]) {
+                    lm->dist[v * lm->count + i] = dist;
+
+                    if (isInHeap(lm->heap, v))
+                        decreaseKey(lm->heap, v, dist, 0);
+                    else
+                        insertKey(lm->heap, v, dist, 0);
+                }
+            }
+        }
+    }
+}
+
+void Landmarks_removeRoad(Landmarks *lm, uint64_t u, uint64_t v, unsigned length) {
+    if (!lm->valid)
+        return;
+
+    for (unsigned i = 0; i < lm->count; i++) {
+        uint64_t distU = lm->dist[u * lm->count + i];
+        uint64_t distV = lm->dist[v * lm->count + i];
+
+        // Distances change only if the road lies on a shortest path from the landmark
+        if (distU != LANDMARK_UNREACHED && (distU + length == distV || distV + length == distU)) {
+            lm->valid = false;
+            lm->staleSearches = 0;
+            return;
+        }
+    }
+}
+
+void Landmarks_free(Landmarks *lm) {
+    free(lm->ids);
+    free(lm->dist);
+    free_Heap(lm->heap);
+    free(lm);
+}
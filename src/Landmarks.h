@@ -0,0 +1,148 @@
+/** @file
+ * Class interface storing distances to landmark cities, which give lower
+ * bounds on the distances between all cities.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_LANDMARKS_H
+#define GRAPHS_LANDMARKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CityRoad.h"
+#include "CsrGraph.h"
+#include "Heap.h"
+#include "SearchWorkspace.h"
+
+/**
+ * Distance of a city not connected with the landmark.
+ */
+#define LANDMARK_UNREACHED UINT64_MAX
+
+/**
+ * Largest map the bounds are used for. Distances on such a map are smaller
+ * than 2^58, so the keys of guided searches do not overflow.
+ */
+#define LANDMARKS_MAX_CITIES (1ULL << 26)
+
+/**
+ * @brief Structure storing the distances of every city to a few landmark cities.
+ * By the triangle inequality |d(L, v) - d(L, t)| is a lower bound of the
+ * distance from v to t for every landmark L. Distances of one city are
+ * stored next to each other, so a bound reads one or two cache lines.
+ */
+typedef struct Landmarks {
+    unsigned requested; /**< Number of landmarks asked for, 0 turns the bounds off. */
+    unsigned count; /**< Number of landmarks in the table. */
+    uint64_t nCities; /**< Number of cities with a row in the table. */
+    uint64_t capacity; /**< Number of rows the table can hold. */
+    uint64_t *ids; /**< Ids of the landmark cities. */
+    uint64_t *dist; /**< Distance of city v to the i-th landmark at index v * count + i. */
+    bool valid; /**< Whether the distances reflect the current roads. */
+    unsigned staleSearches; /**< Number of searches run without the bounds since they became outdated. */
+    Heap *heap; /**< Heap used to spread the distances shortened by a new road. */
+} Landmarks;
+
+/**
+ * @brief Creates an empty table, the bounds are turned off.
+ * @return pointer on the created table, or NULL if memory allocation failed.
+ */
+Landmarks *Landmarks_create(void);
+
+/**
+ * @brief Picks the landmarks and computes the distances of all cities to them.
+ * Every next landmark is the city farthest from the landmarks picked so far,
+ * cities of other connected components first.
+ * @param[in, out] lm - pointer on the table;
+ * @param[in] graph   - valid snapshot of the roads;
+ * @param[in, out] ws - workspace used by the searches from the landmarks;
+ * @param[in] nCities - number of cities in the map;
+ * @param[in] count   - number of landmarks, 0 turns the bounds off.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool Landmarks_build(Landmarks *lm, CsrGraph *graph, SearchWorkspace *ws, uint64_t nCities, unsigned count);
+
+/**
+ * @brief Updates the distances after a road was added.
+ * A new road can only shorten distances, so they are spread from its ends
+ * only as far as they decrease. Cities added to the map get their rows here.
+ * @param[in, out] lm   - pointer on the table;
+ * @param[in] cities    - array of cities indexed by id;
+ * @param[in] nCities   - number of cities in the map;
+ * @param[in] city1     - pointer on a city connected by the road;
+ * @param[in] city2     - pointer on the other city connected by the road;
+ * @param[in] length    - length of the road.
+ */
+void Landmarks_addRoad(Landmarks *lm, City **cities, uint64_t nCities, City *city1, City *city2, unsigned length);
+
+/**
+ * @brief Marks the distances as outdated if a removed road lies on a shortest path from a landmark.
+ * @param[in, out] lm - pointer on the table;
+ * @param[in] u       - id of a city connected by the road;
+ * @param[in] v       - id of the other city connected by the road;
+ * @param[in] length  - length of the road.
+ */
+void Landmarks_removeRoad(Landmarks *lm, uint64_t u, uint64_t v, unsigned length);
+
+/**
+ * @brief Gives a lower bound of the distance between two cities.
+ * @param[in] lm - pointer on a valid table;
+ * @param[in] v  - id of a city;
+ * @param[in] t  - id of the other city.
+ * @return lower bound of the distance, LANDMARK_UNREACHED if the cities are not connected.
+ */
+static inline uint64_t Landmarks_bound(const Landmarks *lm, uint64_t v, uint64_t t) {
+    const uint64_t *distV = lm->dist + v * lm->count;
+    const uint64_t *distT = lm->dist + t * lm->count;
+    uint64_t bound = 0;
+
+    for (unsigned i = 0; i < lm->count; i++) {
+        if (distV[i] == LANDMARK_UNREACHED || distT[i] == LANDMARK_UNREACHED) {
+            // Only one of the cities is connected with the landmark
+            if (distV[i] != distT[i])
+                return LANDMARK_UNREACHED;
+            continue;
+        }
+
+        uint64_t diff = distV[i] > distT[i] ? distV[i] - distT[i] : distT[i] - distV[i];
+
+        if (diff > bound)
+            bound = diff;
+    }
+
+    return bound;
+}
+
+/**
+ * @brief Gives the key of a city in a search guided by the bounds.
+ * The bound is scaled by 7/8, so every road makes the key grow by at least
+ * its length. A city is then settled strictly after all cities preceding it
+ * on its shortest paths, just like without the bounds, so counting the
+ * shortest paths and the year tie-break stay exact.
+ * @param[in] dist  - distance of the city from the source;
+ * @param[in] bound - lower bound of the distance from the city to the destination.
+ * @return key of the city.
+ */
+static inline uint64_t Landmarks_key(uint64_t dist, uint64_t bound) {
+    return 8 * dist + 7 * bound;
+}
+
+/**
+ * @brief Gives a lower bound of the length of a path to the destination through a city.
+ * @param[in] key - key of the city given by @ref Landmarks_key.
+ * @return lower bound of the length of the path.
+ */
+static inline uint64_t Landmarks_keyLength(uint64_t key) {
+    return key / 8;
+}
+
+/**
+ * @brief Frees the table to prevent memory leaks.
+ * @param[in, out] lm - pointer on the table.
+ */
+void Landmarks_free(Landmarks *lm);
+
+#endif //GRAPHS_LANDMARKS_H
@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include "LineReader.h"
+
+LineReader *LineReader_create(FILE *input) {
+    LineReader *reader = (LineReader *) malloc(sizeof(LineReader));
+    if (reader == NULL)
+        return NULL;
+
+    reader->capacity = LINE_READER_BLOCK + 1;
+    reader->buffer = (char *) malloc(reader->capacity);
+
+    if (reader->buffer == NULL) {
+        free(reader);
+        return NULL;
+    }
+
+    reader->fd = fileno(input);
+    reader->start = 0;
+    reader->scanned = 0;
+    reader->end = 0;
+    reader->eof = false;
+    reader->failed = false;
+
+    return reader;
+}
+
+/* Moves the unfinished line to the front of the buffer and reads the next block behind it */
+static bool readBlock(LineReader *reader) {
+    size_t pending = reader->end - reader->start;
+
+    if (reader->start > 0) {
+        memmove(reader->buffer, reader->buffer + reader->start, pending);
+        reader->scanned -= reader->start;
+        reader->start = 0;
+        reader->end = pending;
+    }
+
+    // A line longer than a block makes the buffer grow
+    if (reader->capacity - reader->end <= LINE_READER_BLOCK / 2) {
+        size_t capacity = 2 * reader->capacity;
+        char *buffer = (char *) realloc(reader->buffer, capacity);
+
+        if (buffer == NULL) {
+            reader->failed = true;
+            return false;
+        }
+
+        reader->buffer = buffer;
+        reader->capacity = capacity;
+    }
+
+    // Whatever is available is taken, so commands typed in a terminal are run at once
+    ssize_t bytes;
+    do {
+        bytes = read(reader->fd, reader->buffer + reader->end, reader->capacity - 1 - reader->end);
+    } while (bytes < 0 && errno == EINTR);
+
+    // An error ends the input just like its end
+    if (bytes <= 0)
+        reader->eof = true;
+    else
+        reader->end += bytes;
+
+    return true;
+}
+
+bool LineReader_next(LineReader *reader, char **line, size_t *length, bool *terminated) {
+    while (true) {
+        char *first = reader->buffer + reader->start;
+        char *newline = (char *) memchr(reader->buffer + reader->scanned, '\n', reader->end - reader->scanned);
+
+        if (newline != NULL) {
+            *newline = '\0';
+            *line = first;
+            *length = newline - first;
+            *terminated = true;
+            reader->start = newline + 1 - reader->buffer;
+            reader->scanned = reader->start;
+            return true;
+        }
+
+        reader->scanned = reader->end;
+
+        if (reader->eof) {
+            if (reader->start == reader->end)
+                return false;
+
+            // There is always room for the terminator behind the data
+            reader->buffer[reader->end] = '\0';
+            *line = first;
+            *length = reader->end - reader->start;
+            *terminated = false;
+            reader->start = reader->end;
+            return true;
+        }
+
+        if (!readBlock(reader))
+            return false;
+    }
+}
+
+bool LineReader_ready(LineReader *reader) {
+    if (reader->eof)
+        return true;
+
+    char *newline = (char *) memchr(reader->buffer + reader->scanned, '\n', reader->end - reader->scanned);
+
+    // Either way the next search for the newline starts where this one stopped
+    reader->scanned = newline != NULL ? (size_t) (newline - reader->buffer) : reader->end;
+
+    return newline != NULL;
+}
+
+void LineReader_free(LineReader *reader) {
+    if (reader == NULL)
+        return;
+
+    free(reader->buffer);
+    free(reader);
+}
@@ -0,0 +1,77 @@
+/** @file
+ * Class interface storing a block-buffered reader of lines.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_LINEREADER_H
+#define GRAPHS_LINEREADER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Number of bytes read at once, unless a longer line makes the buffer grow.
+ */
+#define LINE_READER_BLOCK (1 << 20)
+
+/**
+ * @brief Structure storing a reader splitting its input into lines.
+ * The input is read in blocks, taking whatever is available, into one
+ * buffer and lines are given as
+ * pointers into that buffer, terminated in place. Only the part of a line
+ * cut by the end of a block is moved, to the front of the buffer, before
+ * the next block is read behind it.
+ */
+typedef struct LineReader {
+    int fd; /**< Descriptor of the stream the lines are read from. */
+    char *buffer; /**< Bytes read from the input. */
+    size_t capacity; /**< Size of the buffer, one byte is always kept for the terminator. */
+    size_t start; /**< Index of the first byte of the next line. */
+    size_t scanned; /**< Index up to which the next line is known to have no newline. */
+    size_t end; /**< Index behind the last byte read. */
+    bool eof; /**< Whether the input has ended. */
+    bool failed; /**< Whether memory allocation for a long line failed. */
+} LineReader;
+
+/**
+ * @brief Creates a reader of the stream.
+ * The reader reads the descriptor of the stream directly, so the stream
+ * itself must not be read any more.
+ * @param[in] input - stream to be read.
+ * @return pointer on the created reader, or NULL if memory allocation failed.
+ */
+LineReader *LineReader_create(FILE *input);
+
+/**
+ * @brief Gives the next line of the input.
+ * The newline ending the line is replaced with '\0'. The line stays valid
+ * and may be modified until the next call.
+ * @param[in, out] reader  - pointer on the reader;
+ * @param[out] line        - first character of the line;
+ * @param[out] length      - number of characters of the line, without the newline;
+ * @param[out] terminated  - whether the line ended with a newline, only the last one may not.
+ * @return @p true if a line was read, @p false at the end of the input or if
+ * memory allocation failed, then failed is set.
+ */
+bool LineReader_next(LineReader *reader, char **line, size_t *length, bool *terminated);
+
+/**
+ * @brief Checks whether the next line can be given without waiting for the input.
+ * @param[in, out] reader - pointer on the reader.
+ * @return @p true if a whole line is already read or the input has ended,
+ * @p false if the next call of @ref LineReader_next has to read more.
+ */
+bool LineReader_ready(LineReader *reader);
+
+/**
+ * @brief Frees the reader to prevent memory leaks.
+ * The stream is not closed.
+ * @param[in, out] reader - pointer on the reader.
+ */
+void LineReader_free(LineReader *reader);
+
+#endif //GRAPHS_LINEREADER_H
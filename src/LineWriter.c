@@ -0,0 +1,133 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "LineWriter.h"
+
+LineWriter *LineWriter_create(FILE *output) {
+    LineWriter *writer = (LineWriter *) malloc(sizeof(LineWriter));
+    if (writer == NULL)
+        return NULL;
+
+    writer->buffer = (char *) malloc(LINE_WRITER_BLOCK);
+
+    if (writer->buffer == NULL) {
+        free(writer);
+        return NULL;
+    }
+
+    writer->fd = fileno(output);
+    writer->size = 0;
+    writer->interactive = isatty(writer->fd);
+    writer->failed = false;
+
+    return writer;
+}
+
+bool LineWriter_sameFile(const LineWriter *writer, FILE *output) {
+    struct stat first;
+    struct stat second;
+
+    if (fstat(writer->fd, &first) != 0 || fstat(fileno(output), &second) != 0)
+        return false;
+
+    return first.st_dev == second.st_dev && first.st_ino == second.st_ino;
+}
+
+/* Writes all bytes, unless the descriptor fails */
+static void writeAll(LineWriter *writer, const char *chars, size_t length) {
+    while (length > 0 && !writer->failed) {
+        ssize_t bytes = write(writer->fd, chars, length);
+
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes <= 0) {
+            writer->failed = true;
+            return;
+        }
+
+        chars += bytes;
+        length -= bytes;
+    }
+}
+
+void LineWriter_flush(LineWriter *writer) {
+    writeAll(writer, writer->buffer, writer->size);
+    writer->size = 0;
+}
+
+void LineWriter_write(LineWriter *writer, const char *chars, size_t length) {
+    if (writer->size + length > LINE_WRITER_BLOCK) {
+        LineWriter_flush(writer);
+
+        // Text longer than the buffer is not copied at all
+        if (length > LINE_WRITER_BLOCK) {
+            writeAll(writer, chars, length);
+            return;
+        }
+    }
+
+    memcpy(writer->buffer + writer->size, chars, length);
+    writer->size += length;
+}
+
+size_t LineWriter_formatNumber(char *digits, int64_t value) {
+    char reversed[LINE_WRITER_DIGITS];
+    uint64_t magnitude = value < 0 ? -(uint64_t) value : (uint64_t) value;
+    size_t count = 0;
+    size_t length = 0;
+
+    do {
+        reversed[count++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0)
+        digits[length++] = '-';
+
+    while (count > 0)
+        digits[length++] = reversed[--count];
+
+    return length;
+}
+
+size_t LineWriter_numberLength(int64_t value) {
+    uint64_t magnitude = value < 0 ? -(uint64_t) value : (uint64_t) value;
+    size_t length = value < 0 ? 2 : 1;
+
+    while (magnitude >= 10) {
+        magnitude /= 10;
+        length++;
+    }
+
+    return length;
+}
+
+void LineWriter_writeNumber(LineWriter *writer, int64_t value) {
+    if (writer->size + LINE_WRITER_DIGITS > LINE_WRITER_BLOCK)
+        LineWriter_flush(writer);
+
+    writer->size += LineWriter_formatNumber(writer->buffer + writer->size, value);
+}
+
+void LineWriter_endLine(LineWriter *writer) {
+    LineWriter_write(writer, "\n", 1);
+
+    if (writer->interactive)
+        LineWriter_flush(writer);
+}
+
+void LineWriter_free(LineWriter *writer) {
+    if (writer == NULL)
+        return;
+
+    LineWriter_flush(writer);
+    free(writer->buffer);
+    free(writer);
+}
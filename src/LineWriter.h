@@ -0,0 +1,107 @@
+/** @file
+ * Class interface storing a block-buffered writer of lines.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_LINEWRITER_H
+#define GRAPHS_LINEWRITER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Number of bytes collected before they are written at once.
+ */
+#define LINE_WRITER_BLOCK (1 << 16)
+
+/**
+ * Largest number of characters of a formatted number, together with its sign.
+ */
+#define LINE_WRITER_DIGITS 20
+
+/**
+ * @brief Structure storing a writer collecting lines in a buffer.
+ * The buffer is written to the descriptor when it is full, when it is flushed
+ * explicitly and, if the descriptor is a terminal, after every line.
+ */
+typedef struct LineWriter {
+    int fd; /**< Descriptor of the stream the lines are written to. */
+    char *buffer; /**< Bytes not written yet. */
+    size_t size; /**< Number of bytes in the buffer. */
+    bool interactive; /**< Whether the stream is a terminal, so lines are written at once. */
+    bool failed; /**< Whether writing failed, then the following output is dropped. */
+} LineWriter;
+
+/**
+ * @brief Creates a writer of the stream.
+ * The writer writes the descriptor of the stream directly, so nothing should
+ * be written to the stream itself any more.
+ * @param[in] output - stream to be written.
+ * @return pointer on the created writer, or NULL if memory allocation failed.
+ */
+LineWriter *LineWriter_create(FILE *output);
+
+/**
+ * @brief Checks whether the stream goes to the same file as the writer.
+ * Then writing both through one writer keeps their lines in order.
+ * @param[in] writer - pointer on the writer;
+ * @param[in] output - stream to be compared.
+ * @return @p true if both descriptors refer to the same file, @p false otherwise.
+ */
+bool LineWriter_sameFile(const LineWriter *writer, FILE *output);
+
+/**
+ * @brief Adds the characters to the current line.
+ * @param[in, out] writer - pointer on the writer;
+ * @param[in] chars       - characters to be written;
+ * @param[in] length      - number of characters.
+ */
+void LineWriter_write(LineWriter *writer, const char *chars, size_t length);
+
+/**
+ * @brief Adds the decimal number to the current line.
+ * @param[in, out] writer - pointer on the writer;
+ * @param[in] value       - number to be written.
+ */
+void LineWriter_writeNumber(LineWriter *writer, int64_t value);
+
+/**
+ * @brief Ends the current line, writing it at once to a terminal.
+ * @param[in, out] writer - pointer on the writer.
+ */
+void LineWriter_endLine(LineWriter *writer);
+
+/**
+ * @brief Writes everything collected in the buffer.
+ * @param[in, out] writer - pointer on the writer.
+ */
+void LineWriter_flush(LineWriter *writer);
+
+/**
+ * @brief Writes the decimal digits of the number, without a terminator.
+ * @param[out] digits - room for at least LINE_WRITER_DIGITS characters;
+ * @param[in] value   - number to be formatted.
+ * @return number of characters written.
+ */
+size_t LineWriter_formatNumber(char *digits, int64_t value);
+
+/**
+ * @brief Counts the characters of the number written by @ref LineWriter_formatNumber.
+ * @param[in] value - number to be formatted.
+ * @return number of characters, together with the sign.
+ */
+size_t LineWriter_numberLength(int64_t value);
+
+/**
+ * @brief Flushes and frees the writer to prevent memory leaks.
+ * The stream is not closed. Does nothing if the writer is NULL.
+ * @param[in, out] writer - pointer on the writer.
+ */
+void LineWriter_free(LineWriter *writer);
+
+#endif //GRAPHS_LINEWRITER_H
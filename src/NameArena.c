@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <string.h>
+#include "NameArena.h"
+
+#define CHUNK_SIZE 65536
+
+typedef struct NameChunk NameChunk;
+
+struct NameChunk {
+    NameChunk *next;
+    uint64_t padding; /* Keeps the names after the header aligned */
+};
+
+struct NameArena {
+    NameChunk *chunks;
+    char *next;
+    char *end;
+};
+
+uint64_t Name_hash(const char *str, uint64_t length) {
+    uint64_t hash = 5381;
+
+    for (uint64_t i = 0; i < length; i++)
+        hash = ((hash << 5) + hash) + (unsigned char) str[i]; /* hash * 33 + c */
+
+    return hash;
+}
+
+NameKey Name_key(const char *str, uint64_t length) {
+    return (NameKey) {str, length, Name_hash(str, length)};
+}
+
+bool Name_equals(const Name *name, const char *str, uint64_t length, uint64_t hash) {
+    return name->hash == hash && name->length == length && memcmp(name->chars, str, length) == 0;
+}
+
+NameArena *NameArena_create(void) {
+    NameArena *arena = (NameArena *) malloc(sizeof(NameArena));
+
+    if (arena == NULL)
+        return NULL;
+
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+
+    return arena;
+}
+
+static bool addChunk(NameArena *arena, uint64_t size) {
+    if (size < CHUNK_SIZE)
+        size = CHUNK_SIZE;
+
+    NameChunk *chunk = (NameChunk *) malloc(sizeof(NameChunk) + size);
+
+    if (chunk == NULL)
+        return false;
+
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->next = (char *) (chunk + 1);
+    arena->end = arena->next + size;
+
+    return true;
+}
+
+Name *NameArena_store(NameArena *arena, const char *str, uint64_t length, uint64_t hash) {
+    // Records are kept 8-byte aligned for the hash and length fields
+    uint64_t size = (sizeof(Name) + length + 1 + 7) / 8 * 8;
+
+    if ((arena->next == NULL || (uint64_t) (arena->end - arena->next) < size) && !addChunk(arena, size))
+        return NULL;
+
+    Name *name = (Name *) arena->next;
+    arena->next += size;
+
+    name->hash = hash;
+    name->length = length;
+    memcpy(name->chars, str, length);
+    name->chars[length] = '\0';
+
+    return name;
+}
+
+void NameArena_free(NameArena *arena) {
+    NameChunk *chunk = arena->chunks;
+
+    while (chunk != NULL) {
+        NameChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(arena);
+}
@@ -0,0 +1,89 @@
+/** @file
+ * Class interface storing city names in a contiguous arena.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_NAMEARENA_H
+#define GRAPHS_NAMEARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Structure storing an interned name together with its hash and length.
+ * The same record is referenced by the City and by the HashMap.
+ */
+typedef struct Name {
+    uint64_t hash; /**< Hash of the name, computed once when it is stored. */
+    uint64_t length; /**< Length of the name without the terminating zero. */
+    char chars[]; /**< Characters of the name terminated by zero. */
+} Name;
+
+/**
+ * @brief Structure storing a name to be looked up together with its hash and length.
+ * They can be computed in advance, e.g. by a thread parsing commands.
+ */
+typedef struct NameKey {
+    const char *chars; /**< Characters of the name terminated by zero. */
+    uint64_t length; /**< Length of the name without the terminating zero. */
+    uint64_t hash; /**< Hash of the name. */
+} NameKey;
+
+/**
+ * Structure storing the arena the names are allocated from.
+ */
+typedef struct NameArena NameArena;
+
+/**
+ * @brief Hashes the first length characters of the string.
+ * @param[in] str    - pointer on the string;
+ * @param[in] length - number of characters to hash.
+ * @return hash of the string.
+ */
+uint64_t Name_hash(const char *str, uint64_t length);
+
+/**
+ * @brief Computes the key of the first length characters of the string.
+ * @param[in] str    - pointer on the string, the characters are not copied;
+ * @param[in] length - number of characters of the name.
+ * @return key of the name.
+ */
+NameKey Name_key(const char *str, uint64_t length);
+
+/**
+ * @brief Checks whether the stored name is equal to the string.
+ * Compares hash and length before touching the characters.
+ * @param[in] name   - pointer on the stored name;
+ * @param[in] str    - pointer on the string;
+ * @param[in] length - length of the string;
+ * @param[in] hash   - hash of the string.
+ * @return @p true if the name is equal to the string, @p false otherwise.
+ */
+bool Name_equals(const Name *name, const char *str, uint64_t length, uint64_t hash);
+
+/**
+ * @brief Creates an empty arena of names.
+ * @return pointer on the created arena, or NULL if memory allocation failed.
+ */
+NameArena *NameArena_create(void);
+
+/**
+ * @brief Copies the string into the arena.
+ * @param[in, out] arena - pointer on the arena;
+ * @param[in] str        - pointer on the string;
+ * @param[in] length     - length of the string;
+ * @param[in] hash       - hash of the string.
+ * @return pointer on the stored name, or NULL if memory allocation failed.
+ */
+Name *NameArena_store(NameArena *arena, const char *str, uint64_t length, uint64_t hash);
+
+/**
+ * @brief Frees the arena together with all names stored in it.
+ * @param[in, out] arena - pointer on the arena.
+ */
+void NameArena_free(NameArena *arena);
+
+#endif //GRAPHS_NAMEARENA_H
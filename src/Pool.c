@@ -0,0 +1,82 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Pool.h"
+
+#define POOL_ALIGN sizeof(uint64_t)
+#define FIRST_SLAB_OBJECTS 64
+#define MAX_SLAB_OBJECTS 65536
+
+struct PoolSlab {
+    PoolSlab *next;
+    uint64_t padding; /* Keeps the objects after the header aligned */
+};
+
+void Pool_init(Pool *pool, size_t objectSize) {
+    if (objectSize < sizeof(void *))
+        objectSize = sizeof(void *);
+
+    pool->objectSize = (objectSize + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN;
+    pool->slabObjects = FIRST_SLAB_OBJECTS;
+    pool->freeList = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->slabs = NULL;
+}
+
+static bool addSlab(Pool *pool) {
+    PoolSlab *slab = (PoolSlab *) malloc(sizeof(PoolSlab) + pool->slabObjects * pool->objectSize);
+
+    if (slab == NULL)
+        return false;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->next = (char *) (slab + 1);
+    pool->end = pool->next + pool->slabObjects * pool->objectSize;
+
+    // Next slabs grow geometrically, so big maps need few mallocs
+    if (pool->slabObjects < MAX_SLAB_OBJECTS)
+        pool->slabObjects *= 2;
+
+    return true;
+}
+
+void *Pool_alloc(Pool *pool) {
+    if (pool->freeList != NULL) {
+        void *object = pool->freeList;
+        pool->freeList = *(void **) object;
+        return object;
+    }
+
+    if (pool->next == pool->end && !addSlab(pool))
+        return NULL;
+
+    void *object = pool->next;
+    pool->next += pool->objectSize;
+
+    return object;
+}
+
+void Pool_release(Pool *pool, void *object) {
+    if (object == NULL)
+        return;
+
+    *(void **) object = pool->freeList;
+    pool->freeList = object;
+}
+
+void Pool_destroy(Pool *pool) {
+    PoolSlab *slab = pool->slabs;
+
+    while (slab != NULL) {
+        PoolSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pool->freeList = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->slabs = NULL;
+}
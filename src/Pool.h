@@ -0,0 +1,62 @@
+/** @file
+ * Class interface storing a pool allocator of fixed-size objects.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_POOL_H
+#define GRAPHS_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Structure storing a slab of objects allocated with one malloc.
+ */
+typedef struct PoolSlab PoolSlab;
+
+/**
+ * @brief Structure storing a pool of objects of the same size.
+ * Objects are carved from slabs by bumping a pointer, released objects
+ * are kept on a free list and reused before the slab is bumped again.
+ */
+typedef struct Pool {
+    size_t objectSize; /**< Size of one object, rounded up for alignment. */
+    size_t slabObjects; /**< Number of objects in the next slab to be allocated. */
+    void *freeList; /**< Released objects, linked through their first bytes. */
+    char *next; /**< Next unused object of the current slab. */
+    char *end; /**< End of the current slab. */
+    PoolSlab *slabs; /**< All slabs of the pool. */
+} Pool;
+
+/**
+ * @brief Initialises an empty pool.
+ * @param[out] pool      - pointer on the pool;
+ * @param[in] objectSize - size of the objects allocated from the pool.
+ */
+void Pool_init(Pool *pool, size_t objectSize);
+
+/**
+ * @brief Allocates an object from the pool.
+ * @param[in, out] pool - pointer on the pool.
+ * @return pointer on the uninitialised object, or NULL if memory allocation failed.
+ */
+void *Pool_alloc(Pool *pool);
+
+/**
+ * @brief Gives the object back to the pool for reuse.
+ * Does nothing if the object is NULL.
+ * @param[in, out] pool - pointer on the pool;
+ * @param[in] object    - pointer on the object allocated from this pool.
+ */
+void Pool_release(Pool *pool, void *object);
+
+/**
+ * @brief Frees all slabs of the pool at once.
+ * All objects allocated from the pool become invalid.
+ * @param[in, out] pool - pointer on the pool.
+ */
+void Pool_destroy(Pool *pool);
+
+#endif //GRAPHS_POOL_H
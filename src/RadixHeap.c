@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include "RadixHeap.h"
+
+RadixHeap *RadixHeap_create(void) {
+    RadixHeap *heap = (RadixHeap *) malloc(sizeof(RadixHeap));
+
+    if (heap == NULL)
+        return NULL;
+
+    heap->size = 0;
+    heap->last = 0;
+
+    for (int i = 0; i < RADIX_BUCKETS; i++) {
+        heap->buckets[i].size = 0;
+        heap->buckets[i].capacity = 0;
+        heap->buckets[i].nodes = NULL;
+    }
+
+    return heap;
+}
+
+void RadixHeap_clear(RadixHeap *heap) {
+    heap->size = 0;
+    heap->last = 0;
+
+    for (int i = 0; i < RADIX_BUCKETS; i++)
+        heap->buckets[i].size = 0;
+}
+
+static inline int bucketIndex(uint64_t distance, uint64_t last) {
+    uint64_t diff = distance ^ last;
+
+    if (diff == 0)
+        return 0;
+
+#if defined(__GNUC__)
+    return 64 - __builtin_clzll(diff);
+#else
+    int bits = 0;
+    while (diff != 0) {
+        diff >>= 1;
+        bits++;
+    }
+    return bits;
+#endif
+}
+
+/* Makes room for at least count nodes in the bucket, doubling its capacity */
+static bool reserve(RadixBucket *bucket, uint64_t count) {
+    if (count <= bucket->capacity)
+        return true;
+
+    uint64_t capacity = bucket->capacity == 0 ? 64 : 2 * bucket->capacity;
+    while (capacity < count)
+        capacity *= 2;
+
+    HeapNode *nodes = (HeapNode *) realloc(bucket->nodes, capacity * sizeof(HeapNode));
+
+    if (nodes == NULL)
+        return false;
+
+    bucket->nodes = nodes;
+    bucket->capacity = capacity;
+
+    return true;
+}
+
+static bool append(RadixBucket *bucket, HeapNode node) {
+    if (!reserve(bucket, bucket->size + 1))
+        return false;
+
+    bucket->nodes[bucket->size++] = node;
+
+    return true;
+}
+
+/* Keeps bucket 0 sorted by year descending, so the oldest year is popped first */
+static bool insertSorted(RadixBucket *bucket, HeapNode node) {
+    if (!append(bucket, node))
+        return false;
+
+    uint64_t i = bucket->size - 1;
+
+    while (i > 0 && bucket->nodes[i - 1].year < node.year) {
+        bucket->nodes[i] = bucket->nodes[i - 1];
+        i--;
+    }
+
+    bucket->nodes[i] = node;
+
+    return true;
+}
+
+static int compareYearsDescending(const void *a, const void *b) {
+    int yearA = ((const HeapNode *) a)->year;
+    int yearB = ((const HeapNode *) b)->year;
+
+    return (yearA < yearB) - (yearA > yearB);
+}
+
+bool RadixHeap_push(RadixHeap *heap, uint64_t id, uint64_t distance, int year) {
+    HeapNode node = {distance, year, id};
+    int i = bucketIndex(distance, heap->last);
+    bool pushed = i == 0 ? insertSorted(&heap->buckets[0], node) : append(&heap->buckets[i], node);
+
+    if (pushed)
+        heap->size++;
+
+    return pushed;
+}
+
+bool RadixHeap_pop(RadixHeap *heap, HeapNode *min) {
+    if (heap->size == 0)
+        return false;
+
+    RadixBucket *zero = &heap->buckets[0];
+
+    if (zero->size == 0) {
+        int i = 1;
+        while (heap->buckets[i].size == 0)
+            i++;
+
+        // The smallest distance of the bucket becomes the new reference point
+        RadixBucket *bucket = &heap->buckets[i];
+        uint64_t last = bucket->nodes[0].distance;
+
+        for (uint64_t j = 1; j < bucket->size; j++) {
+            if (bucket->nodes[j].distance < last)
+                last = bucket->nodes[j].distance;
+        }
+
+        // Lower buckets get room for all the moved nodes first, so a failed
+        // allocation leaves the heap as it was
+        uint64_t moved[RADIX_BUCKETS] = {0};
+
+        for (uint64_t j = 0; j < bucket->size; j++)
+            moved[bucketIndex(bucket->nodes[j].distance, last)]++;
+
+        for (int k = 0; k < i; k++) {
+            if (!reserve(&heap->buckets[k], heap->buckets[k].size + moved[k]))
+                return false;
+        }
+
+        heap->last = last;
+
+        // Every node of the bucket moves to a lower bucket
+        for (uint64_t j = 0; j < bucket->size; j++) {
+            HeapNode node = bucket->nodes[j];
+            RadixBucket *target = &heap->buckets[bucketIndex(node.distance, last)];
+
+            target->nodes[target->size++] = node;
+        }
+
+        bucket->size = 0;
+        qsort(zero->nodes, zero->size, sizeof(HeapNode), compareYearsDescending);
+    }
+
+    *min = zero->nodes[--zero->size];
+    heap->size--;
+
+    return true;
+}
+
+void RadixHeap_free(RadixHeap *heap) {
+    for (int i = 0; i < RADIX_BUCKETS; i++)
+        free(heap->buckets[i].nodes);
+
+    free(heap);
+}
@@ -0,0 +1,83 @@
+/** @file
+ * Class interface storing a monotone radix heap for integer distances.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_RADIXHEAP_H
+#define GRAPHS_RADIXHEAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Heap.h"
+
+/**
+ * Number of buckets: one for the last extracted distance and one for every
+ * position of the highest bit in which a distance differs from it.
+ */
+#define RADIX_BUCKETS 65
+
+/**
+ * @brief Structure storing a bucket of the radix heap.
+ */
+typedef struct RadixBucket {
+    uint64_t size; /**< Number of nodes in the bucket. */
+    uint64_t capacity; /**< Allocated size of the nodes array. */
+    HeapNode *nodes; /**< Nodes of the bucket. */
+} RadixBucket;
+
+/**
+ * @brief Structure storing a radix heap.
+ * Works only for monotone sequences of operations, where no node is pushed
+ * with a distance smaller than the last extracted one, as in dijkstra
+ * algorithm with non-negative road lengths. Nodes are never moved up, a
+ * better label of a vertex is pushed as a new node and the caller skips the
+ * outdated ones. Nodes are extracted in the same order as from the Heap:
+ * smaller distance first, on equal distance the older year first.
+ */
+typedef struct RadixHeap {
+    uint64_t size; /**< Number of nodes in all buckets. */
+    uint64_t last; /**< Last extracted distance. */
+    RadixBucket buckets[RADIX_BUCKETS]; /**< Bucket 0 is kept sorted by year, oldest last. */
+} RadixHeap;
+
+/**
+ * @brief Creates an empty radix heap.
+ * @return pointer on the created radix heap, or NULL if malloc failed.
+ */
+RadixHeap *RadixHeap_create(void);
+
+/**
+ * @brief Removes all nodes from the radix heap, keeping the allocated buckets.
+ * @param[in, out] heap - pointer on the radix heap.
+ */
+void RadixHeap_clear(RadixHeap *heap);
+
+/**
+ * @brief Pushes a node into the radix heap.
+ * @param[in, out] heap - pointer on the radix heap;
+ * @param[in] id        - id of the node;
+ * @param[in] distance  - distance of the node, not smaller than the last extracted one;
+ * @param[in] year      - year of the node.
+ * @return @p true on success, @p false if realloc failed.
+ */
+bool RadixHeap_push(RadixHeap *heap, uint64_t id, uint64_t distance, int year);
+
+/**
+ * @brief Extracts the node with min distance and oldest year.
+ * @param[in, out] heap - pointer on the radix heap;
+ * @param[out] min      - the extracted node.
+ * @return @p true if a node was extracted, @p false if the radix heap is empty
+ * or memory allocation failed, then the radix heap is left unchanged.
+ */
+bool RadixHeap_pop(RadixHeap *heap, HeapNode *min);
+
+/**
+ * @brief Frees the radix heap to prevent memory leaks.
+ * @param[in, out] heap - pointer on the radix heap.
+ */
+void RadixHeap_free(RadixHeap *heap);
+
+#endif //GRAPHS_RADIXHEAP_H
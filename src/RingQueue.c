@@ -0,0 +1,84 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "RingQueue.h"
+
+RingQueue *RingQueue_create(uint64_t capacity) {
+    RingQueue *queue = (RingQueue *) malloc(sizeof(RingQueue));
+    if (queue == NULL)
+        return NULL;
+
+    uint64_t size = 1;
+    while (size < capacity)
+        size *= 2;
+
+    queue->items = (void **) malloc(size * sizeof(void *));
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+
+    queue->mask = size - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->sleeping, false);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->pushed, NULL);
+
+    return queue;
+}
+
+bool RingQueue_push(RingQueue *queue, void *item) {
+    uint64_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&queue->head, memory_order_acquire) > queue->mask)
+        return false;
+
+    queue->items[tail & queue->mask] = item;
+
+    // Publishing the item and checking for a sleeping consumer are both sequentially consistent,
+    // so either the consumer sees the item before it sleeps or the producer sees it sleeping
+    atomic_store(&queue->tail, tail + 1);
+
+    if (atomic_load(&queue->sleeping)) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_signal(&queue->pushed);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return true;
+}
+
+void *RingQueue_pop(RingQueue *queue) {
+    uint64_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    bool empty = true;
+
+    for (unsigned i = 0; i < RING_QUEUE_SPINS && empty; i++)
+        empty = atomic_load_explicit(&queue->tail, memory_order_acquire) == head;
+
+    if (empty) {
+        pthread_mutex_lock(&queue->lock);
+        atomic_store(&queue->sleeping, true);
+
+        while (atomic_load(&queue->tail) == head)
+            pthread_cond_wait(&queue->pushed, &queue->lock);
+
+        atomic_store(&queue->sleeping, false);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    void *item = queue->items[head & queue->mask];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return item;
+}
+
+void RingQueue_free(RingQueue *queue) {
+    if (queue == NULL)
+        return;
+
+    pthread_cond_destroy(&queue->pushed);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+    free(queue);
+}
@@ -0,0 +1,77 @@
+/** @file
+ * Class interface storing a bounded lock-free queue between two threads.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_RINGQUEUE_H
+#define GRAPHS_RINGQUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * Assumed size of a cache line, the indices of both threads are kept on different lines.
+ */
+#define RING_QUEUE_LINE 64
+
+/**
+ * Number of times an empty queue is checked again before the consumer goes to sleep.
+ */
+#define RING_QUEUE_SPINS 1024
+
+/**
+ * @brief Structure storing a queue of pointers with one producer and one consumer.
+ * The items are kept in a ring, the producer advances only the tail and the
+ * consumer only the head, so neither of them takes a lock while the queue is
+ * neither empty nor full. A consumer finding the queue empty for longer goes
+ * to sleep on a condition variable, and the producer takes the lock only to
+ * wake it up.
+ */
+typedef struct RingQueue {
+    void **items; /**< Ring of the items, its size is a power of two. */
+    uint64_t mask; /**< Size of the ring minus one. */
+    atomic_uint_fast64_t head; /**< Number of items popped so far, written by the consumer. */
+    char headPadding[RING_QUEUE_LINE]; /**< Keeps the head and the tail on different cache lines. */
+    atomic_uint_fast64_t tail; /**< Number of items pushed so far, written by the producer. */
+    char tailPadding[RING_QUEUE_LINE]; /**< Keeps the tail and the fields below on different cache lines. */
+    atomic_bool sleeping; /**< Whether the consumer waits for an item on the condition variable. */
+    pthread_mutex_t lock; /**< Protects going to sleep and waking up. */
+    pthread_cond_t pushed; /**< Signalled when an item is pushed while the consumer sleeps. */
+} RingQueue;
+
+/**
+ * @brief Creates an empty queue.
+ * @param[in] capacity - number of items the queue can hold, rounded up to a power of two.
+ * @return pointer on the created queue, or NULL if memory allocation failed.
+ */
+RingQueue *RingQueue_create(uint64_t capacity);
+
+/**
+ * @brief Adds the item at the end of the queue, only the producer may call it.
+ * @param[in, out] queue - pointer on the queue;
+ * @param[in] item       - pointer to be passed to the consumer.
+ * @return @p true if the item was added, @p false if the queue is full.
+ */
+bool RingQueue_push(RingQueue *queue, void *item);
+
+/**
+ * @brief Takes the first item of the queue, only the consumer may call it.
+ * Waits until an item is pushed if the queue is empty.
+ * @param[in, out] queue - pointer on the queue.
+ * @return the first item.
+ */
+void *RingQueue_pop(RingQueue *queue);
+
+/**
+ * @brief Frees the queue, the items are not touched.
+ * Does nothing if the queue is NULL.
+ * @param[in, out] queue - pointer on the queue.
+ */
+void RingQueue_free(RingQueue *queue);
+
+#endif //GRAPHS_RINGQUEUE_H
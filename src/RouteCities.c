@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "RouteCities.h"
+
+static inline uint64_t hashId(uint64_t id) {
+    uint64_t h = id;
+
+    // Finalizer of splitmix64
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+
+    return h;
+}
+
+RouteCities *RouteCities_create(uint64_t capacity) {
+    RouteCities *cities = (RouteCities *) malloc(sizeof(RouteCities));
+    if (cities == NULL)
+        return NULL;
+
+    uint64_t size = 16;
+    while (size < capacity)
+        size *= 2;
+
+    cities->slots = (CitySlot *) malloc(size * sizeof(CitySlot));
+    if (cities->slots == NULL) {
+        free(cities);
+        return NULL;
+    }
+
+    for (uint64_t i = 0; i < size; i++)
+        cities->slots[i].position = ROUTE_NO_POSITION;
+
+    cities->members = NULL;
+    cities->nWords = 0;
+    cities->mask = size - 1;
+    cities->count = 0;
+
+    return cities;
+}
+
+uint64_t RouteCities_find(const RouteCities *cities, uint64_t id) {
+    uint64_t i = hashId(id) & cities->mask;
+
+    while (cities->slots[i].position != ROUTE_NO_POSITION) {
+        if (cities->slots[i].id == id)
+            return cities->slots[i].position;
+
+        i = (i + 1) & cities->mask;
+    }
+
+    return ROUTE_NO_POSITION;
+}
+
+static void placeSlot(CitySlot *slots, uint64_t mask, uint64_t id, uint64_t position) {
+    uint64_t i = hashId(id) & mask;
+
+    while (slots[i].position != ROUTE_NO_POSITION)
+        i = (i + 1) & mask;
+
+    slots[i].id = id;
+    slots[i].position = position;
+}
+
+static bool grow(RouteCities *cities) {
+    uint64_t size = 2 * (cities->mask + 1);
+    CitySlot *slots = (CitySlot *) malloc(size * sizeof(CitySlot));
+
+    if (slots == NULL)
+        return false;
+
+    for (uint64_t i = 0; i < size; i++)
+        slots[i].position = ROUTE_NO_POSITION;
+
+    for (uint64_t i = 0; i <= cities->mask; i++) {
+        CitySlot *slot = &cities->slots[i];
+
+        if (slot->position != ROUTE_NO_POSITION)
+            placeSlot(slots, size - 1, slot->id, slot->position);
+    }
+
+    free(cities->slots);
+    cities->slots = slots;
+    cities->mask = size - 1;
+
+    return true;
+}
+
+static bool reserveMembers(RouteCities *cities, uint64_t id) {
+    if ((id >> 6) < cities->nWords)
+        return true;
+
+    uint64_t nWords = 2 * cities->nWords;
+    if (nWords <= (id >> 6))
+        nWords = (id >> 6) + 1;
+
+    uint64_t *members = (uint64_t *) realloc(cities->members, nWords * sizeof(uint64_t));
+    if (members == NULL)
+        return false;
+
+    memset(members + cities->nWords, 0, (nWords - cities->nWords) * sizeof(uint64_t));
+    cities->members = members;
+    cities->nWords = nWords;
+
+    return true;
+}
+
+bool RouteCities_insert(RouteCities *cities, uint64_t id, uint64_t position) {
+    uint64_t i = hashId(id) & cities->mask;
+
+    // Replacing the position of a city cannot fail
+    while (cities->slots[i].position != ROUTE_NO_POSITION) {
+        if (cities->slots[i].id == id) {
+            cities->slots[i].position = position;
+            return true;
+        }
+
+        i = (i + 1) & cities->mask;
+    }
+
+    if (!reserveMembers(cities, id))
+        return false;
+
+    // Keep the load factor under 50% so probe sequences stay short
+    if (2 * (cities->count + 1) > cities->mask + 1) {
+        if (!grow(cities))
+            return false;
+
+        placeSlot(cities->slots, cities->mask, id, position);
+    } else {
+        cities->slots[i].id = id;
+        cities->slots[i].position = position;
+    }
+
+    cities->members[id >> 6] |= UINT64_C(1) << (id & 63);
+    cities->count++;
+
+    return true;
+}
+
+bool RouteCities_reserve(RouteCities *cities, uint64_t count, uint64_t maxId) {
+    if (!reserveMembers(cities, maxId))
+        return false;
+
+    while (2 * (cities->count + count) > cities->mask + 1) {
+        if (!grow(cities))
+            return false;
+    }
+
+    return true;
+}
+
+void RouteCities_remove(RouteCities *cities, uint64_t id) {
+    uint64_t mask = cities->mask;
+    uint64_t i = hashId(id) & mask;
+
+    while (cities->slots[i].position != ROUTE_NO_POSITION) {
+        if (cities->slots[i].id == id)
+            break;
+
+        i = (i + 1) & mask;
+    }
+
+    if (cities->slots[i].position == ROUTE_NO_POSITION)
+        return;
+
+    // Backward shift deletion: move up every following slot whose
+    // probe sequence passes through the freed one
+    uint64_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+
+        if (cities->slots[j].position == ROUTE_NO_POSITION)
+            break;
+
+        uint64_t home = hashId(cities->slots[j].id) & mask;
+
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            cities->slots[i] = cities->slots[j];
+            i = j;
+        }
+    }
+
+    cities->slots[i].position = ROUTE_NO_POSITION;
+    cities->members[id >> 6] &= ~(UINT64_C(1) << (id & 63));
+    cities->count--;
+}
+
+void RouteCities_free(RouteCities *cities) {
+    if (cities == NULL)
+        return;
+
+    free(cities->members);
+    free(cities->slots);
+    free(cities);
+}
@@ -0,0 +1,105 @@
+/** @file
+ * Class interface storing the cities of one route, a bit set for membership
+ * and a hash index of their positions keyed by city ids.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_ROUTECITIES_H
+#define GRAPHS_ROUTECITIES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CityRoad.h"
+
+/**
+ * Position of a city which is not on the route, marks also an empty slot.
+ */
+#define ROUTE_NO_POSITION UINT64_MAX
+
+/**
+ * @brief Structure storing a slot of the hash index.
+ */
+typedef struct RouteCities_slot {
+    uint64_t id; /**< Id of the city. */
+    uint64_t position; /**< Index of the city in the arrays of the route. */
+} CitySlot;
+
+/**
+ * @brief Structure storing the cities of one route.
+ * Searches around the route only ask whether a city is on it, so membership
+ * is answered by a bit set, which is much smaller than the hash index and
+ * stays in cache during the search. The bit set grows up to the largest id
+ * of a city on the route.
+ */
+struct RouteCities {
+    uint64_t *members; /**< Bit set of the ids of the cities on the route. */
+    uint64_t nWords; /**< Number of words of the bit set. */
+    CitySlot *slots; /**< Open addressing table of the positions of the cities. */
+    uint64_t mask; /**< Number of slots minus one, the number of slots is a power of two. */
+    uint64_t count; /**< Number of cities on the route. */
+};
+
+/**
+ * @brief Creates an empty index of cities.
+ * @param[in] capacity - initial number of slots, rounded up to a power of two.
+ * @return pointer on the created index, or NULL if memory allocation failed.
+ */
+RouteCities *RouteCities_create(uint64_t capacity);
+
+/**
+ * @brief Checks whether the city is on the route.
+ * @param[in] cities - pointer on the index;
+ * @param[in] id     - id of the city.
+ * @return @p true if the city is on the route, @p false otherwise.
+ */
+static inline bool RouteCities_contains(const RouteCities *cities, uint64_t id) {
+    return (id >> 6) < cities->nWords && ((cities->members[id >> 6] >> (id & 63)) & 1) != 0;
+}
+
+/**
+ * @brief Searches for the position of the city on the route.
+ * @param[in] cities - pointer on the index;
+ * @param[in] id     - id of the city.
+ * @return index of the city in the arrays of the route, ROUTE_NO_POSITION if it is not on the route.
+ */
+uint64_t RouteCities_find(const RouteCities *cities, uint64_t id);
+
+/**
+ * @brief Inserts the city together with its position.
+ * The position of a city already in the index is replaced without enlarging it.
+ * Otherwise, if the index is filled in more than a half, then it is enlarged.
+ * @param[in, out] cities - pointer on the index;
+ * @param[in] id          - id of the city;
+ * @param[in] position    - index of the city in the arrays of the route.
+ * @return @p true if the city was inserted, @p false if memory allocation failed.
+ */
+bool RouteCities_insert(RouteCities *cities, uint64_t id, uint64_t position);
+
+/**
+ * @brief Makes room for new cities, so inserting them cannot fail.
+ * @param[in, out] cities - pointer on the index;
+ * @param[in] count       - number of cities to be inserted;
+ * @param[in] maxId       - largest id of the cities to be inserted.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool RouteCities_reserve(RouteCities *cities, uint64_t count, uint64_t maxId);
+
+/**
+ * @brief Removes the city.
+ * Does nothing if there is no such city in the index.
+ * @param[in, out] cities - pointer on the index;
+ * @param[in] id          - id of the city.
+ */
+void RouteCities_remove(RouteCities *cities, uint64_t id);
+
+/**
+ * @brief Frees the index to prevent memory leaks.
+ * Does nothing if the index is NULL.
+ * @param[in, out] cities - pointer on the index.
+ */
+void RouteCities_free(RouteCities *cities);
+
+#endif //GRAPHS_ROUTECITIES_H
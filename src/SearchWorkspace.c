@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+#include "SearchWorkspace.h"
+
+#define INITIAL_CAPACITY 1024
+
+SearchWorkspace *SearchWorkspace_create(void) {
+    SearchWorkspace *ws = (SearchWorkspace *) malloc(sizeof(SearchWorkspace));
+
+    if (ws == NULL)
+        return NULL;
+
+    ws->heap = Heap_create(INITIAL_CAPACITY);
+    ws->radix = RadixHeap_create();
+
+    if (ws->heap == NULL || ws->radix == NULL) {
+        if (ws->heap != NULL)
+            free_Heap(ws->heap);
+        if (ws->radix != NULL)
+            RadixHeap_free(ws->radix);
+        free(ws);
+        return NULL;
+    }
+
+    ws->queue = QUEUE_HEAP;
+
+    ws->capacity = 0;
+    ws->epoch = 0;
+    ws->stamp = NULL;
+    ws->dist = NULL;
+    ws->keys = NULL;
+    ws->years = NULL;
+    ws->parent = NULL;
+    ws->paths = NULL;
+    ws->settled = NULL;
+    ws->nSettled = 0;
+    ws->failed = false;
+
+    return ws;
+}
+
+static bool grow(SearchWorkspace *ws, uint64_t nCities) {
+    uint64_t capacity = ws->capacity == 0 ? INITIAL_CAPACITY : ws->capacity;
+    while (capacity < nCities)
+        capacity *= 2;
+
+    uint32_t *stamp = (uint32_t *) realloc(ws->stamp, capacity * sizeof(uint32_t));
+    if (stamp == NULL)
+        return false;
+    ws->stamp = stamp;
+
+    // New cities must not look labelled by any epoch
+    memset(ws->stamp + ws->capacity, 0, (capacity - ws->capacity) * sizeof(uint32_t));
+
+    uint64_t *dist = (uint64_t *) realloc(ws->dist, capacity * sizeof(uint64_t));
+    if (dist == NULL)
+        return false;
+    ws->dist = dist;
+
+    uint64_t *keys = (uint64_t *) realloc(ws->keys, capacity * sizeof(uint64_t));
+    if (keys == NULL)
+        return false;
+    ws->keys = keys;
+
+    int *years = (int *) realloc(ws->years, capacity * sizeof(int));
+    if (years == NULL)
+        return false;
+    ws->years = years;
+
+    City **parent = (City **) realloc(ws->parent, capacity * sizeof(City *));
+    if (parent == NULL)
+        return false;
+    ws->parent = parent;
+
+    uint8_t *paths = (uint8_t *) realloc(ws->paths, capacity * sizeof(uint8_t));
+    if (paths == NULL)
+        return false;
+    ws->paths = paths;
+
+    uint64_t *settled = (uint64_t *) realloc(ws->settled, capacity * sizeof(uint64_t));
+    if (settled == NULL)
+        return false;
+    ws->settled = settled;
+
+    if (!Heap_reserve(ws->heap, capacity))
+        return false;
+
+    ws->capacity = capacity;
+
+    return true;
+}
+
+void SearchWorkspace_setQueue(SearchWorkspace *ws, SearchQueue queue) {
+    ws->queue = queue;
+}
+
+bool SearchWorkspace_begin(SearchWorkspace *ws, uint64_t nCities) {
+    if (nCities > ws->capacity && !grow(ws, nCities))
+        return false;
+
+    Heap_clear(ws->heap);
+    RadixHeap_clear(ws->radix);
+    ws->nSettled = 0;
+    ws->failed = false;
+
+    // Stamps of the previous searches are all older than the new epoch,
+    // only when the counter wraps around they have to be cleared
+    if (ws->epoch >= UINT32_MAX - 3) {
+        memset(ws->stamp, 0, ws->capacity * sizeof(uint32_t));
+        ws->epoch = 0;
+    }
+
+    ws->epoch += 2;
+
+    return true;
+}
+
+bool SearchWorkspace_relax(SearchWorkspace *ws, uint64_t v, uint64_t dist, uint64_t key, int year, City *parent) {
+    ws->dist[v] = dist;
+    ws->keys[v] = key;
+    ws->years[v] = year;
+    ws->parent[v] = parent;
+
+    if (ws->queue == QUEUE_RADIX) {
+        ws->stamp[v] = ws->epoch;
+
+        if (!RadixHeap_push(ws->radix, v, key, year)) {
+            ws->failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    // The heap has room for every city since the workspace grew
+    if (!SearchWorkspace_isLabelled(ws, v)) {
+        ws->stamp[v] = ws->epoch;
+        insertKey(ws->heap, v, key, year);
+    } else {
+        decreaseKey(ws->heap, v, key, year);
+    }
+
+    return true;
+}
+
+uint64_t SearchWorkspace_extractMin(SearchWorkspace *ws) {
+    HeapNode heapNode;
+
+    if (ws->queue == QUEUE_RADIX) {
+        // Skip the nodes of settled cities and the outdated labels
+        do {
+            if (!RadixHeap_pop(ws->radix, &heapNode)) {
+                // A heap which is not empty could not move its nodes to lower buckets
+                if (ws->radix->size > 0)
+                    ws->failed = true;
+
+                return UINT64_MAX;
+            }
+        } while (SearchWorkspace_isSettled(ws, heapNode.id) || heapNode.distance != ws->keys[heapNode.id] ||
+                 heapNode.year != ws->years[heapNode.id]);
+    } else if (!extract_Min(ws->heap, &heapNode)) {
+        return UINT64_MAX;
+    }
+
+    ws->stamp[heapNode.id] = ws->epoch + 1;
+    ws->settled[ws->nSettled++] = heapNode.id;
+
+    return heapNode.id;
+}
+
+void SearchWorkspace_free(SearchWorkspace *ws) {
+    free(ws->stamp);
+    free(ws->dist);
+    free(ws->keys);
+    free(ws->years);
+    free(ws->parent);
+    free(ws->paths);
+    free(ws->settled);
+    free_Heap(ws->heap);
+    RadixHeap_free(ws->radix);
+    free(ws);
+}
@@ -0,0 +1,151 @@
+/** @file
+ * Class interface storing the reusable state of shortest path searches.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_SEARCHWORKSPACE_H
+#define GRAPHS_SEARCHWORKSPACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CityRoad.h"
+#include "Heap.h"
+#include "RadixHeap.h"
+
+/**
+ * @brief Priority queue used by the searches.
+ */
+typedef enum SearchQueue {
+    QUEUE_HEAP, /**< Indexed 4-ary heap with decrease key. */
+    QUEUE_RADIX /**< Monotone radix heap, outdated labels are skipped on extraction. */
+} SearchQueue;
+
+/**
+ * @brief Structure storing per-city labels of a search, kept between searches.
+ * Labels are reset lazily: a city whose stamp is older than the current epoch
+ * was not reached by the current search, so starting a new search is O(1)
+ * and a search only pays for the cities it touches.
+ */
+typedef struct SearchWorkspace {
+    uint64_t capacity; /**< Number of cities the arrays can hold. */
+    uint32_t epoch; /**< Stamp of the current search. */
+    uint32_t *stamp; /**< epoch if the city is labelled, epoch + 1 if it is settled. */
+    uint64_t *dist; /**< Distance from the source. */
+    uint64_t *keys; /**< Priority of the city in the queue, the distance unless a search is guided. */
+    int *years; /**< Oldest year of a road on the path from the source. */
+    City **parent; /**< Previous city on the path from the source. */
+    uint8_t *paths; /**< Number of shortest paths from the source, 2 stands for two or more. */
+    uint64_t *settled; /**< Cities in the order they were settled by the current search. */
+    uint64_t nSettled; /**< Number of cities settled by the current search. */
+    bool failed; /**< Whether memory allocation failed in the current search, so its labels are incomplete. */
+    SearchQueue queue; /**< Priority queue used by the searches. */
+    Heap *heap; /**< Heap of the labelled, not yet settled cities. */
+    RadixHeap *radix; /**< Radix heap of the labels, used instead of the heap. */
+} SearchWorkspace;
+
+/**
+ * @brief Creates an empty workspace.
+ * @return pointer on the created workspace, or NULL if memory allocation failed.
+ */
+SearchWorkspace *SearchWorkspace_create(void);
+
+/**
+ * @brief Selects the priority queue used by the next searches.
+ * @param[in, out] ws - pointer on the workspace;
+ * @param[in] queue   - priority queue to be used.
+ */
+void SearchWorkspace_setQueue(SearchWorkspace *ws, SearchQueue queue);
+
+/**
+ * @brief Starts a new search on a graph with the given number of cities.
+ * Grows the arrays if the map has grown and invalidates all labels.
+ * @param[in, out] ws  - pointer on the workspace;
+ * @param[in] nCities  - number of cities in the map.
+ * @return @p true on success, @p false if memory allocation failed.
+ */
+bool SearchWorkspace_begin(SearchWorkspace *ws, uint64_t nCities);
+
+/**
+ * @brief Checks whether the city was reached by the current search.
+ * @param[in] ws - pointer on the workspace;
+ * @param[in] v  - id of the city.
+ * @return @p true if the city has a label, @p false otherwise.
+ */
+static inline bool SearchWorkspace_isLabelled(const SearchWorkspace *ws, uint64_t v) {
+    return ws->stamp[v] - ws->epoch <= 1;
+}
+
+/**
+ * @brief Checks whether the label of the city is final.
+ * @param[in] ws - pointer on the workspace;
+ * @param[in] v  - id of the city.
+ * @return @p true if the city was extracted from the heap, @p false otherwise.
+ */
+static inline bool SearchWorkspace_isSettled(const SearchWorkspace *ws, uint64_t v) {
+    return ws->stamp[v] == ws->epoch + 1;
+}
+
+/**
+ * @brief Gives the distance of the city, UINT64_MAX if it was not reached.
+ * @param[in] ws - pointer on the workspace;
+ * @param[in] v  - id of the city.
+ * @return distance from the source of the current search.
+ */
+static inline uint64_t SearchWorkspace_dist(const SearchWorkspace *ws, uint64_t v) {
+    return SearchWorkspace_isLabelled(ws, v) ? ws->dist[v] : UINT64_MAX;
+}
+
+/**
+ * @brief Gives the oldest year on the path to the city, INT32_MAX if it was not reached.
+ * @param[in] ws - pointer on the workspace;
+ * @param[in] v  - id of the city.
+ * @return oldest year of a road on the path from the source.
+ */
+static inline int SearchWorkspace_year(const SearchWorkspace *ws, uint64_t v) {
+    return SearchWorkspace_isLabelled(ws, v) ? ws->years[v] : INT32_MAX;
+}
+
+/**
+ * @brief Gives the previous city on the path, NULL if there is none.
+ * @param[in] ws - pointer on the workspace;
+ * @param[in] v  - id of the city.
+ * @return pointer on the parent city.
+ */
+static inline City *SearchWorkspace_parent(const SearchWorkspace *ws, uint64_t v) {
+    return SearchWorkspace_isLabelled(ws, v) ? ws->parent[v] : NULL;
+}
+
+/**
+ * @brief Sets the label of the city and puts it into the priority queue.
+ * Keys of the relaxed cities must not be smaller than the key of the last
+ * extracted city.
+ * @param[in, out] ws - pointer on the workspace;
+ * @param[in] v       - id of the city;
+ * @param[in] dist    - distance from the source;
+ * @param[in] key     - priority of the city, the distance or a guided estimate;
+ * @param[in] year    - oldest year of a road on the path;
+ * @param[in] parent  - previous city on the path.
+ * @return @p true if the city was put into the queue, @p false if memory allocation
+ * failed, then the search is marked as failed.
+ */
+bool SearchWorkspace_relax(SearchWorkspace *ws, uint64_t v, uint64_t dist, uint64_t key, int year, City *parent);
+
+/**
+ * @brief Extracts the city with the smallest label and marks it as settled.
+ * The city is appended to the list of settled cities.
+ * @param[in, out] ws - pointer on the workspace.
+ * @return id of the extracted city, or UINT64_MAX if the priority queue is empty
+ * or memory allocation failed, then the search is marked as failed.
+ */
+uint64_t SearchWorkspace_extractMin(SearchWorkspace *ws);
+
+/**
+ * @brief Frees the workspace to prevent memory leaks.
+ * @param[in, out] ws - pointer on the workspace.
+ */
+void SearchWorkspace_free(SearchWorkspace *ws);
+
+#endif //GRAPHS_SEARCHWORKSPACE_H
@@ -0,0 +1,144 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "WorkerPool.h"
+
+struct WorkerThread {
+    WorkerPool *pool;
+    unsigned worker;
+    pthread_t thread;
+};
+
+unsigned WorkerPool_defaultWorkers(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (processors < 1)
+        return 1;
+
+    return processors < WORKER_POOL_MAX_WORKERS ? (unsigned) processors : WORKER_POOL_MAX_WORKERS;
+}
+
+/* Runs tasks of the current batch until none is left */
+static void runTasks(WorkerPool *pool, unsigned worker) {
+    uint64_t task;
+
+    while ((task = atomic_fetch_add(&pool->next, 1)) < pool->nTasks)
+        pool->run(pool->context, worker, task);
+}
+
+static void *workerLoop(void *argument) {
+    WorkerThread *thread = (WorkerThread *) argument;
+    WorkerPool *pool = thread->pool;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (true) {
+        while (!pool->stopping && pool->batch == seen)
+            pthread_cond_wait(&pool->started, &pool->lock);
+
+        if (pool->stopping)
+            break;
+
+        seen = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        runTasks(pool, thread->worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0)
+            pthread_cond_signal(&pool->finished);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/* Stops and joins the first count threads */
+static void stopThreads(WorkerPool *pool, unsigned count) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 0; i < count; i++)
+        pthread_join(pool->threads[i].thread, NULL);
+}
+
+WorkerPool *WorkerPool_create(unsigned nWorkers) {
+    WorkerPool *pool = (WorkerPool *) malloc(sizeof(WorkerPool));
+    if (pool == NULL)
+        return NULL;
+
+    if (nWorkers < 1)
+        nWorkers = 1;
+
+    pool->threads = (WorkerThread *) malloc(nWorkers * sizeof(WorkerThread));
+    if (pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->started, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    atomic_init(&pool->next, 0);
+    pool->nWorkers = nWorkers;
+    pool->run = NULL;
+    pool->context = NULL;
+    pool->nTasks = 0;
+    pool->batch = 0;
+    pool->busy = 0;
+    pool->stopping = false;
+
+    for (unsigned i = 0; i + 1 < nWorkers; i++) {
+        pool->threads[i].pool = pool;
+        pool->threads[i].worker = i + 1;
+
+        if (pthread_create(&pool->threads[i].thread, NULL, workerLoop, &pool->threads[i]) != 0) {
+            stopThreads(pool, i);
+            pool->nWorkers = 0;
+            WorkerPool_free(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void WorkerPool_run(WorkerPool *pool, WorkerTask run, void *context, uint64_t nTasks) {
+    pthread_mutex_lock(&pool->lock);
+    pool->run = run;
+    pool->context = context;
+    pool->nTasks = nTasks;
+    atomic_store(&pool->next, 0);
+    pool->busy = pool->nWorkers - 1;
+    pool->batch++;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->lock);
+
+    runTasks(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0)
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void WorkerPool_free(WorkerPool *pool) {
+    if (pool == NULL)
+        return;
+
+    if (pool->nWorkers > 1)
+        stopThreads(pool, pool->nWorkers - 1);
+
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->started);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
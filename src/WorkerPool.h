@@ -0,0 +1,86 @@
+/** @file
+ * Class interface storing a pool of worker threads.
+ *
+ * @author Gor Stepanyan <gs404865@mimuw.edu.pl>
+ * @copyright Gor Stepanyan
+ * @date 18.10.2026
+ */
+
+#ifndef GRAPHS_WORKERPOOL_H
+#define GRAPHS_WORKERPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * Largest number of workers a pool is created with by default.
+ */
+#define WORKER_POOL_MAX_WORKERS 8
+
+/**
+ * Structure storing a thread of the pool together with its worker number.
+ */
+typedef struct WorkerThread WorkerThread;
+
+/**
+ * @brief Function running one task of a batch.
+ * @param[in, out] context - data shared by the tasks of the batch;
+ * @param[in] worker       - number of the worker running the task, smaller than the number of workers;
+ * @param[in] task         - number of the task, smaller than the number of tasks.
+ */
+typedef void (*WorkerTask)(void *context, unsigned worker, uint64_t task);
+
+/**
+ * @brief Structure storing a pool of threads running batches of independent tasks.
+ * The thread starting a batch is worker 0 and runs tasks as well, the other
+ * workers wait for batches on a condition variable. Tasks are handed out
+ * one by one from an atomic counter, so long tasks do not hold up the others.
+ */
+typedef struct WorkerPool {
+    unsigned nWorkers; /**< Number of workers, together with the thread starting batches. */
+    WorkerThread *threads; /**< Threads of workers 1 .. nWorkers - 1. */
+    pthread_mutex_t lock; /**< Protects the fields below the counter. */
+    pthread_cond_t started; /**< Signalled when a batch starts or the pool stops. */
+    pthread_cond_t finished; /**< Signalled when the last worker leaves a batch. */
+    atomic_uint_fast64_t next; /**< Number of the next task to be handed out. */
+    WorkerTask run; /**< Function running the tasks of the current batch. */
+    void *context; /**< Data of the current batch. */
+    uint64_t nTasks; /**< Number of tasks of the current batch. */
+    uint64_t batch; /**< Number of batches started so far. */
+    unsigned busy; /**< Number of threads still working on the current batch. */
+    bool stopping; /**< Whether the threads should exit. */
+} WorkerPool;
+
+/**
+ * @brief Gives the number of workers matching the online processors.
+ * @return number of processors, at least 1 and at most WORKER_POOL_MAX_WORKERS.
+ */
+unsigned WorkerPool_defaultWorkers(void);
+
+/**
+ * @brief Creates a pool and starts its threads.
+ * @param[in] nWorkers - number of workers, 1 runs every batch on the calling thread.
+ * @return pointer on the created pool, or NULL if memory allocation or starting a thread failed.
+ */
+WorkerPool *WorkerPool_create(unsigned nWorkers);
+
+/**
+ * @brief Runs a batch of tasks and waits until all of them are finished.
+ * Tasks may run in any order and on any worker.
+ * @param[in, out] pool    - pointer on the pool;
+ * @param[in] run          - function running one task;
+ * @param[in, out] context - data passed to every task;
+ * @param[in] nTasks       - number of tasks.
+ */
+void WorkerPool_run(WorkerPool *pool, WorkerTask run, void *context, uint64_t nTasks);
+
+/**
+ * @brief Stops the threads and frees the pool.
+ * Does nothing if the pool is NULL.
+ * @param[in, out] pool - pointer on the pool.
+ */
+void WorkerPool_free(WorkerPool *pool);
+
+#endif //GRAPHS_WORKERPOOL_H
@@ -3,14 +3,23 @@
 #include <stdint.h>
 #include <string.h>
 #include <assert.h>
+#include <stdatomic.h>
 #include "map.h"
 #include "HashMap.h"
 #include "Heap.h"
 #include "CityRoad.h"
+#include "CsrGraph.h"
+#include "EdgeIndex.h"
+#include "SearchWorkspace.h"
+#include "Landmarks.h"
+#include "ContractionHierarchy.h"
+#include "RouteCities.h"
+#include "WorkerPool.h"
+#include "Fields.h"
 
 #define HASH_MAP_SIZE 1000
-#define BUFF_SIZE 10000
 #define MAP_CITIES_SIZE 1000
+#define HIERARCHY_STALE_QUERIES 256
 
 Map *newMap(void) {
     Map *map = (Map *) malloc(sizeof(Map));
@@ -29,69 +38,122 @@ Map *newMap(void) {
         map->routes[i] = NULL;
     }
 
+    ObjectPools_init(&map->pools);
     map->nameToCity = create_hmap(HASH_MAP_SIZE);
+    map->names = NameArena_create();
+    map->graph = CsrGraph_create();
+    map->roads = EdgeIndex_create(HASH_MAP_SIZE);
+    map->workspace = SearchWorkspace_create();
+    map->reverseWorkspace = SearchWorkspace_create();
+    map->landmarks = Landmarks_create();
+    map->hierarchy = ContractionHierarchy_create();
+    map->workers = NULL;
+    map->workerSpaces = NULL;
+
+    if (map->names == NULL || map->graph == NULL || map->roads == NULL || map->workspace == NULL ||
+        map->reverseWorkspace == NULL || map->landmarks == NULL || map->hierarchy == NULL)
+        return NULL;
 
     return map;
 }
 
-void UnusedRoute_free(Route *route) {
-    if (route == NULL)
-        return;
-
-    RouteNode *current = route->routeNodeList->head;
+static inline void AllRoutes_free(Map *map) {
+    for (uint64_t i = 0; i < ROUTES_SIZE; i++)
+        Route_free(map->routes[i]);
+}
 
-    while (current != NULL) {
-        RouteNode *next = current->next;
-        free(current);
-        current = next;
+static void freeWorkers(Map *map) {
+    if (map->workers != NULL) {
+        // The workspace of worker 0 is the one of the map
+        for (unsigned i = 1; i < map->workers->nWorkers; i++)
+            SearchWorkspace_free(map->workerSpaces[i]);
     }
 
-    free(route->routeNodeList);
-    free(route);
+    WorkerPool_free(map->workers);
+    free(map->workerSpaces);
+    map->workers = NULL;
+    map->workerSpaces = NULL;
 }
 
-static inline void AllRoutes_free(Map *map) {
-    for (uint64_t i = 0; i < ROUTES_SIZE; i++) {
-        if (map->routes[i] != NULL) {
-            RouteNode *routeNode = map->routes[i]->routeNodeList->head;
+bool prepareWorkers(Map *map, unsigned count) {
+    freeWorkers(map);
 
-            while (routeNode != NULL) {
-                RouteNode *next = routeNode->next;
-                free(routeNode);
-                routeNode = next;
-            }
+    if (count < 1)
+        count = 1;
 
-            free(map->routes[i]->routeNodeList);
-            free(map->routes[i]);
+    map->workerSpaces = (SearchWorkspace **) calloc(count, sizeof(SearchWorkspace *));
+    if (map->workerSpaces == NULL)
+        return false;
+
+    map->workerSpaces[0] = map->workspace;
+
+    for (unsigned i = 1; i < count; i++) {
+        map->workerSpaces[i] = SearchWorkspace_create();
+
+        if (map->workerSpaces[i] == NULL) {
+            while (i-- > 1)
+                SearchWorkspace_free(map->workerSpaces[i]);
+
+            free(map->workerSpaces);
+            map->workerSpaces = NULL;
+            return false;
         }
     }
+
+    map->workers = WorkerPool_create(count);
+    if (map->workers == NULL) {
+        for (unsigned i = 1; i < count; i++)
+            SearchWorkspace_free(map->workerSpaces[i]);
+
+        free(map->workerSpaces);
+        map->workerSpaces = NULL;
+        return false;
+    }
+
+    return true;
 }
 
-void deleteMap(Map *map) {
-    for (uint64_t i = 0; i < map->nCities; i++) {
-        Road *road = (Road *) map->cities[i]->roadsList->head;
+/* Gives the pool to run searches on, created on first use, NULL if there is only one worker */
+static WorkerPool *concurrentWorkers(Map *map) {
+    if (map->workers == NULL && !prepareWorkers(map, WorkerPool_defaultWorkers()))
+        return NULL;
 
-        while (road != NULL) {
-            Road *nextRoad = road->nextRoadOfCity;
-            free(road);
-            road = nextRoad;
-        }
+    if (map->workers->nWorkers < 2)
+        return NULL;
 
-        free(map->cities[i]->roadsList);
-        free(map->cities[i]->cityName);
-        free(map->cities[i]);
-    }
+    // Workers search with the same queue as the map
+    for (unsigned i = 1; i < map->workers->nWorkers; i++)
+        SearchWorkspace_setQueue(map->workerSpaces[i], map->workspace->queue);
+
+    return map->workers;
+}
 
+void deleteMap(Map *map) {
     AllRoutes_free(map);
 
+    // Cities, roads, route nodes and lists live in the pools
+    ObjectPools_destroy(&map->pools);
+
     // Free hash map
     free_hmap(map->nameToCity);
+    NameArena_free(map->names);
+    CsrGraph_free(map->graph);
+    EdgeIndex_free(map->roads);
+    SearchWorkspace_free(map->workspace);
+    SearchWorkspace_free(map->reverseWorkspace);
+    Landmarks_free(map->landmarks);
+    ContractionHierarchy_free(map->hierarchy);
+    freeWorkers(map);
     free(map->cities);
     free(map);
 }
 
-static inline void addCityOnMap(Map *map, City *city) {
-    // 1. Add in cities
+static inline bool addCityOnMap(Map *map, City *city) {
+    // 1. Add in hashMap, a full one leaves the map unchanged
+    if (!set_hmap(map->nameToCity, city->cityName, city))
+        return false;
+
+    // 2. Add in cities
     map->cities[map->nCities] = city;
     // Count of the cities in the array map->cities
     map->nCities++;
@@ -102,45 +164,54 @@ static inline void addCityOnMap(Map *map, City *city) {
         map->cities = (City **) realloc(map->cities, map->citiesSize * sizeof(City *));
     }
 
-    // 2. Add in hashMap
-    set_hmap(map->nameToCity, (void *) city->cityName, city);
+    return true;
 }
 
-static inline City *getFromHashMap(Map *map, const char *city) {
-    City *firstCity = (City *) search_hmap(map->nameToCity, (void *) city);
+static inline City *getFromHashMap(Map *map, const NameKey *city) {
+    City *firstCity = (City *) search_hmap_key(map->nameToCity, city);
 
     // Create the city if it does not exist
     if (firstCity == NULL) {
-        firstCity = City_create(city, map->nCities);
+        Name *name = NameArena_store(map->names, city->chars, city->length, city->hash);
 
-        // If allocation succeeds
-        if (firstCity != NULL) {
-            addCityOnMap(map, firstCity);
-            firstCity->visited = false;
-        } else
+        if (name == NULL)
             return NULL;
+
+        firstCity = City_create(&map->pools, name, map->nCities);
+
+        if (firstCity == NULL)
+            return NULL;
+
+        // Give the city back if it cannot be found by its name
+        if (!addCityOnMap(map, firstCity)) {
+            Pool_release(&map->pools.lists, firstCity->roadsList);
+            Pool_release(&map->pools.cities, firstCity);
+            return NULL;
+        }
     }
 
     return firstCity;
 }
 
-static inline bool checkCityName(const char *name) {
-    if (strcmp(name, "") == 0)
-        return false;
-
-    uint64_t i = 0;
-    while (name[i] != '\0') {
-        if ((name[i] >= 0 && name[i] <= 31) || name[i] == 59)
-            return false;
-        i++;
-    }
+static inline bool checkCityName(const NameKey *name) {
+    return Fields_isName(name->chars, name->length);
+}
 
-    return true;
+static inline bool sameNames(const NameKey *name1, const NameKey *name2) {
+    return name1->hash == name2->hash && name1->length == name2->length &&
+           memcmp(name1->chars, name2->chars, name1->length) == 0;
 }
 
 bool addRoad(Map *map, const char *city1, const char *city2, unsigned length, int builtYear) {
+    NameKey key1 = Name_key(city1, strlen(city1));
+    NameKey key2 = Name_key(city2, strlen(city2));
+
+    return addRoadKeyed(map, &key1, &key2, length, builtYear);
+}
+
+bool addRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2, unsigned length, int builtYear) {
     // If the city names are the same or the builtYear is wrong
-    if (!checkCityName(city1) || !checkCityName(city2) || strcmp(city1, city2) == 0 || builtYear == 0 || length <= 0) {
+    if (!checkCityName(city1) || !checkCityName(city2) || sameNames(city1, city2) || builtYear == 0 || length <= 0) {
         return false;
     }
 
@@ -153,56 +224,90 @@ bool addRoad(Map *map, const char *city1, const char *city2, unsigned length, in
         return false;
 
     // When road between cities already exist
-    if (areConnected(firstCity, secondCity) != NULL)
+    if (areConnected(map->roads, firstCity, secondCity) != NULL)
         return false;
 
+    Road *road1 = Road_create(&map->pools, secondCity, length, builtYear);
+    Road *road2 = Road_create(&map->pools, firstCity, length, builtYear);
+
+    // Index both directions before linking, so failed allocation leaves the map unchanged
+    if (road1 == NULL || road2 == NULL ||
+        !EdgeIndex_insert(map->roads, firstCity->id, secondCity->id, road1) ||
+        !EdgeIndex_insert(map->roads, secondCity->id, firstCity->id, road2)) {
+        EdgeIndex_remove(map->roads, firstCity->id, secondCity->id);
+        Pool_release(&map->pools.roads, road1);
+        Pool_release(&map->pools.roads, road2);
+        return false;
+    }
+
     // Create road for city1 with adjCity city2
     if (firstCity->roadsList->head == NULL) {
-        Road *road = Road_create(secondCity, length, builtYear);
-        firstCity->roadsList->head = road;
-        firstCity->roadsList->tail = road;
+        firstCity->roadsList->head = road1;
+        firstCity->roadsList->tail = road1;
     } else {
         Road *tail = (Road *) firstCity->roadsList->tail;
-        tail->nextRoadOfCity = Road_create(secondCity, length, builtYear);
-        tail->nextRoadOfCity->adjCity->visited = false;
-        firstCity->roadsList->tail = tail->nextRoadOfCity;
+        tail->nextRoadOfCity = road1;
+        firstCity->roadsList->tail = road1;
     }
 
     // Create road for city2 with adjCity city1
     if (secondCity->roadsList->head == NULL) {
-        Road *road = Road_create(firstCity, length, builtYear);
-        secondCity->roadsList->head = road;
-        secondCity->roadsList->tail = road;
+        secondCity->roadsList->head = road2;
+        secondCity->roadsList->tail = road2;
     } else {
         Road *tail = (Road *) secondCity->roadsList->tail;
-        tail->nextRoadOfCity = Road_create(firstCity, length, builtYear);
-        tail->nextRoadOfCity->adjCity->visited = false;
-        secondCity->roadsList->tail = tail->nextRoadOfCity;
+        tail->nextRoadOfCity = road2;
+        secondCity->roadsList->tail = road2;
     }
 
+    CsrGraph_invalidate(map->graph);
+    ContractionHierarchy_invalidate(map->hierarchy);
+    Landmarks_addRoad(map->landmarks, map->cities, map->nCities, firstCity, secondCity, length);
+
     return true;
 }
 
-void repairInRoute(Route *route, City *city1, City *city2, int repairYear) {
-    RouteNode *current = route->routeNodeList->head;
+/* Routes going along a road are kept on its direction from the city with the smaller id */
+static inline Road *indexedRoad(Map *map, City *city1, City *city2) {
+    if (city1->id > city2->id)
+        return areConnected(map->roads, city2, city1);
+
+    return areConnected(map->roads, city1, city2);
+}
 
-    while (current != NULL) {
-        if (current->next != NULL && ((current->city == city1 && current->next->city == city2) ||
-                                      (current->city == city2 && current->next->city == city1)))
-            current->age = repairYear;
+/* Records the route with the given id on the roads of path */
+static bool indexRouteRoads(Map *map, unsigned routeId, const Route *path) {
+    for (uint64_t i = path->first; i + 1 < path->first + path->count; i++) {
+        City *from = path->cities[i];
 
-        current = current->next;
+        if (!RouteUse_add(&map->pools, indexedRoad(map, from, path->cities[i + 1]), routeId, from))
+            return false;
     }
+
+    return true;
+}
+
+/* Forgets the route with the given id on the roads of path */
+static void unindexRouteRoads(Map *map, unsigned routeId, const Route *path) {
+    for (uint64_t i = path->first; i + 1 < path->first + path->count; i++)
+        RouteUse_remove(&map->pools, indexedRoad(map, path->cities[i], path->cities[i + 1]), routeId);
 }
 
 bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear) {
+    NameKey key1 = Name_key(city1, strlen(city1));
+    NameKey key2 = Name_key(city2, strlen(city2));
+
+    return repairRoadKeyed(map, &key1, &key2, repairYear);
+}
+
+bool repairRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2, int repairYear) {
     if (!checkCityName(city1) || !checkCityName(city2))
         return false;
 
-    City *firstCity = search_hmap(map->nameToCity, (void *) city1);
-    City *secondCity = search_hmap(map->nameToCity, (void *) city2);
-    Road *road1 = areConnected(firstCity, secondCity);
-    Road *road2 = areConnected(secondCity, firstCity);
+    City *firstCity = search_hmap_key(map->nameToCity, city1);
+    City *secondCity = search_hmap_key(map->nameToCity, city2);
+    Road *road1 = areConnected(map->roads, firstCity, secondCity);
+    Road *road2 = areConnected(map->roads, secondCity, firstCity);
 
     if (!firstCity || !secondCity || road1 == NULL || road2 == NULL || repairYear == 0 ||
         road1->builtYear > repairYear || road2->builtYear > repairYear)
@@ -210,503 +315,861 @@ bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear)
 
     road1->builtYear = repairYear;
     road2->builtYear = repairYear;
+    CsrGraph_setYear(map->graph, firstCity->id, secondCity->id, repairYear);
+    CsrGraph_setYear(map->graph, secondCity->id, firstCity->id, repairYear);
 
-    for (int i = 1; i < ROUTES_SIZE; ++i) {
-        if (map->routes[i] != NULL) {
-            repairInRoute(map->routes[i], firstCity, secondCity, repairYear);
-        }
+    // Only the routes going along the road are touched
+    for (RouteUse *use = indexedRoad(map, firstCity, secondCity)->routeUses; use != NULL; use = use->next) {
+        Route *route = map->routes[use->routeId];
+        Route_setYear(route, RouteCities_find(route->index, use->from->id), repairYear);
     }
 
     return true;
 }
 
-static inline void Route_getUtil(City **parent, City *destination, Route *route) {
-    if (parent[destination->id] == NULL)
-        return;
+static inline int compareMin(int year1, int year2) {
+    return year1 < year2 ? year1 : year2;
+}
 
-    Route_getUtil(parent, parent[destination->id], route);
+/* Appends the city connected by a road with the last city of the route */
+static inline bool appendByRoad(Map *map, Route *route, City *city) {
+    Road *road = areConnected(map->roads, Route_tail(route), city);
 
-    RouteNode *lastRouteNode = route->routeNodeList->tail;
-    Road *road = areConnected(lastRouteNode->city, destination);
-    lastRouteNode->length = road->length;
-    lastRouteNode->age = road->builtYear;
-    lastRouteNode->next = RouteNode_create(destination, 0, 0);
-    route->routeNodeList->tail = lastRouteNode->next;
+    return Route_append(route, city, road->length, road->builtYear);
 }
 
-static inline Route *Route_get(City **parent, City *destination, City *srcCity) {
-    Route *route = Route_create();
-    RouteNode *routeNode = RouteNode_create(srcCity, 0, 0);
-    route->routeNodeList->head = routeNode;
-    route->routeNodeList->tail = routeNode;
-    Route_getUtil(parent, destination, route);
+/* Builds the route from the source of the search to destination following the parents */
+static inline Route *Route_get(Map *map, SearchWorkspace *ws, City *destination) {
+    uint64_t count = 1;
 
-    return route;
-}
+    for (City *city = SearchWorkspace_parent(ws, destination->id); city != NULL;
+         city = SearchWorkspace_parent(ws, city->id))
+        count++;
 
-static inline int compareMin(int year1, int year2) {
-    return year1 < year2 ? year1 : year2;
-}
+    Route *route = Route_create(count);
+
+    if (route == NULL)
+        return NULL;
+
+    // Parents lead from the destination back to the source, so the route is filled from its end
+    City *city = destination;
 
-bool isUnique(Route *optimalPath, uint64_t const *dist, int const *years) {
-    RouteNode *prevInOptimal = (RouteNode *) optimalPath->routeNodeList->head;
-    RouteNode *nextInOptimal = prevInOptimal->next;
+    for (uint64_t i = count; i-- > 0; city = SearchWorkspace_parent(ws, city->id))
+        route->cities[i] = city;
 
-    while (nextInOptimal != NULL) {
-        Road *nextCityNeighbour = (Road *) nextInOptimal->city->roadsList->head;
-        uint64_t nextCityId = nextInOptimal->city->id;
+    route->count = count;
 
-        while (nextCityNeighbour != NULL) {
-            if (nextCityNeighbour->adjCity != prevInOptimal->city) {
-                uint64_t neighbourId = nextCityNeighbour->adjCity->id;
-                uint64_t length = nextCityNeighbour->length;
-                int year = nextCityNeighbour->builtYear;
+    for (uint64_t i = 0; i + 1 < count; i++) {
+        Road *road = areConnected(map->roads, route->cities[i], route->cities[i + 1]);
+        route->lengths[i] = road->length;
+        route->years[i] = road->builtYear;
+        route->length += road->length;
+        route->oldestYear = compareMin(route->oldestYear, road->builtYear);
+    }
 
-                if ((dist[neighbourId] + length == dist[nextCityId]) &&
-                    compareMin(years[neighbourId], year) <= years[nextCityId])
-                    return false;
+    return route;
+}
+
+static inline uint8_t addPaths(uint8_t paths1, uint8_t paths2) {
+    return paths1 + paths2 < 2 ? paths1 + paths2 : 2;
+}
+
+/* Relaxes the roads of the settled city u and counts the shortest paths to its neighbours.
+ * Every road to a city at the same distance is another shortest path, whatever its year is,
+ * so a city reached by two or more of them makes a route through it ambiguous.
+ * With landmarks the keys are guided towards target and cities not connected with it are skipped.
+ * Cities of the excluded route, apart from target, are never entered.
+ * In the bidirectional search other is the workspace of the opposite side and best is
+ * shortened when a road leads to a city reached from there. Returns false if memory
+ * allocation failed. */
+static inline bool scanRoads(Map *map, SearchWorkspace *ws, Landmarks const *landmarks, uint64_t target,
+                             RouteCities const *excluded, SearchWorkspace const *other, uint64_t u,
+                             uint64_t *best) {
+    CsrGraph *graph = map->graph;
+    uint64_t distU = ws->dist[u];
+    int yearU = ws->years[u];
+    uint8_t pathsU = ws->paths[u];
+    uint64_t end = graph->offsets[u + 1];
+
+    for (uint64_t e = graph->offsets[u]; e < end; e++) {
+        uint64_t v = graph->targets[e];
+        uint64_t distV = distU + graph->lengths[e];
+
+        if (other != NULL && SearchWorkspace_isLabelled(other, v) && distV + other->dist[v] < *best)
+            *best = distV + other->dist[v];
+
+        if (SearchWorkspace_isSettled(ws, v))
+            continue;
+
+        if (excluded != NULL && v != target && RouteCities_contains(excluded, v))
+            continue;
+
+        int yearV = compareMin(graph->years[e], yearU);
+        uint64_t currentDist = SearchWorkspace_dist(ws, v);
+
+        if (distV < currentDist) {
+            uint64_t key = distV;
+
+            if (landmarks != NULL) {
+                uint64_t bound = Landmarks_bound(landmarks, v, target);
+
+                if (bound == LANDMARK_UNREACHED)
+                    continue;
+
+                key = Landmarks_key(distV, bound);
             }
 
-            nextCityNeighbour = nextCityNeighbour->nextRoadOfCity;
-        }
+            if (!SearchWorkspace_relax(ws, v, distV, key, yearV, map->cities[u]))
+                return false;
+            ws->paths[v] = pathsU;
+        } else if (distV == currentDist) {
+            ws->paths[v] = addPaths(ws->paths[v], pathsU);
 
-        prevInOptimal = nextInOptimal;
-        nextInOptimal = nextInOptimal->next;
+            if (yearV > ws->years[v] && !SearchWorkspace_relax(ws, v, distV, ws->keys[v], yearV, map->cities[u]))
+                return false;
+        }
     }
 
     return true;
 }
 
-Route *dijkstra(Map *map, City *src, City *destination) {
-    uint64_t vertices = map->nCities; // Get the number of vertices in graph
-    uint64_t dist[vertices];      // Dist values used to pick minimum weight edge in cut
-    int years[vertices];          // Years array is used to keep the oldest year from source
-    City *parent[vertices];       // Parent array to get the optimalPath by recursion
+bool prepareLandmarks(Map *map, unsigned count) {
+    if (!map->graph->valid && !CsrGraph_rebuild(map->graph, map->cities, map->nCities))
+        return false;
+
+    return Landmarks_build(map->landmarks, map->graph, map->workspace, map->nCities, count);
+}
+
+/* Gives the landmarks if they can guide the next search, otherwise NULL. Outdated landmarks
+ * are rebuilt only after as many searches as there are landmarks ran without them, so a map
+ * changed before every search does not pay more for rebuilding than it could gain. */
+static Landmarks *guidingLandmarks(Map *map) {
+    Landmarks *landmarks = map->landmarks;
 
-    Heap *heap = Heap_create(vertices);
-    if (heap == NULL)
+    if (landmarks->requested == 0 || map->nCities > LANDMARKS_MAX_CITIES)
         return NULL;
 
-    for (uint64_t v = 0; v < vertices; ++v) {
-        parent[v] = NULL;
-        dist[v] = UINT64_MAX;
-        years[v] = INT32_MAX;
-        heap->array[v] = HeapNode_create(v, dist[v], years[v]);
-        if (heap->array[v] == NULL)
+    // A city added without its road has no row yet
+    if (landmarks->valid && landmarks->nCities != map->nCities) {
+        landmarks->valid = false;
+        landmarks->staleSearches = 0;
+    }
+
+    if (!landmarks->valid) {
+        if (++landmarks->staleSearches < landmarks->requested)
             return NULL;
 
-        heap->pos[v] = v;
+        if (!Landmarks_build(landmarks, map->graph, map->workspace, map->nCities, landmarks->requested) ||
+            !landmarks->valid)
+            return NULL;
     }
 
-    heap->array[src->id]->id = src->id;
-    heap->array[src->id]->distance = dist[src->id];
-    heap->array[src->id]->year = years[src->id];
+    return landmarks;
+}
 
-    heap->pos[src->id] = src->id;
-    dist[src->id] = 0;
-    years[src->id] = INT32_MAX;
-    heap->size = vertices;
-    decreaseKey(heap, src->id, dist[src->id], years[src->id]);
+/* Runs the search on a valid graph. It only reads the map, so searches
+ * with different workspaces may run at the same time. If limit is given,
+ * the search gives up as soon as every path it could still find is longer
+ * than the value limit has then. */
+static Route *searchRoute(Map *map, SearchWorkspace *ws, Landmarks const *landmarks, City *src,
+                          City *destination, RouteCities const *excluded, atomic_uint_fast64_t *limit) {
+    uint64_t srcKey = 0;
 
-    while (!isEmpty(heap)) {
-        // Extract the vertex with minimum distance value
-        HeapNode *heapNode = extract_Min(heap);
-        uint64_t u = heapNode->id;
-        Road *pCrawl = (Road *) map->cities[u]->roadsList->head;
+    if (landmarks != NULL) {
+        uint64_t bound = Landmarks_bound(landmarks, src->id, destination->id);
 
-        while (pCrawl != NULL) {
-            uint64_t v = pCrawl->adjCity->id;
+        if (bound == LANDMARK_UNREACHED)
+            return NULL;
 
-            if (isInHeap(heap, v) && pCrawl->adjCity->visited == false && dist[u] != UINT64_MAX &&
-                (pCrawl->length + dist[u] < dist[v] ||
-                 (pCrawl->length + dist[u] == dist[v] && compareMin(pCrawl->builtYear, years[u]) > years[v]))) {
-                dist[v] = dist[u] + pCrawl->length;
-                years[v] = compareMin( pCrawl->builtYear, years[u]);
-                parent[v] = map->cities[u];
+        srcKey = Landmarks_key(0, bound);
+    }
 
-                decreaseKey(heap, v, dist[v], years[v]);
-            }
+    // Labels of the previous search are dropped in O(1)
+    if (!SearchWorkspace_begin(ws, map->nCities))
+        return NULL;
+
+    if (!SearchWorkspace_relax(ws, src->id, 0, srcKey, INT32_MAX, NULL))
+        return NULL;
+    ws->paths[src->id] = 1;
+
+    uint64_t u;
+    while ((u = SearchWorkspace_extractMin(ws)) != UINT64_MAX) {
+        // Keys do not decrease, so no path through a later city is shorter either
+        if (limit != NULL) {
+            uint64_t length = landmarks != NULL ? Landmarks_keyLength(ws->keys[u]) : ws->keys[u];
 
-            pCrawl = pCrawl->nextRoadOfCity;
+            if (length > atomic_load_explicit(limit, memory_order_relaxed))
+                return NULL;
         }
 
-        free(heapNode);
+        // Roads are longer than 0, so all shortest paths to the destination are counted
+        // before it is settled and the cities still in the queue cannot change its label
+        if (u == destination->id)
+            break;
+
+        if (!scanRoads(map, ws, landmarks, destination->id, excluded, NULL, u, NULL))
+            return NULL;
     }
 
-    free_Heap(heap);
+    // A queue which ran out of memory looks empty, but the labels are incomplete
+    if (ws->failed)
+        return NULL;
+
+    // The route exists only if exactly one shortest path leads to the destination
+    if (!SearchWorkspace_isSettled(ws, destination->id) || ws->paths[destination->id] != 1)
+        return NULL;
+
+    return Route_get(map, ws, destination);
+}
 
-    Route *optimalPath = Route_get(parent, destination, src);
-    RouteNode *tail = optimalPath->routeNodeList->tail;
+Route *dijkstra(Map *map, City *src, City *destination, RouteCities const *excluded) {
+    CsrGraph *graph = map->graph;
 
-    if (isUnique(optimalPath, dist, years) && tail->city == destination) {
-        return optimalPath;
+    // Flatten the adjacency lists if roads were added or removed since the last search
+    if (!graph->valid && !CsrGraph_rebuild(graph, map->cities, map->nCities))
+        return NULL;
+
+    return searchRoute(map, map->workspace, guidingLandmarks(map), src, destination, excluded, NULL);
+}
+
+/* Counts the shortest paths through the roads on which they leave the forward search.
+ * Saves one of these roads in meetFrom and meetTo. */
+static uint8_t countMeetingPaths(Map *map, SearchWorkspace const *forward, SearchWorkspace const *backward,
+                                 uint64_t dest, uint64_t best, uint64_t *meetFrom, uint64_t *meetTo) {
+    CsrGraph *graph = map->graph;
+    uint8_t paths = 0;
+
+    // A shortest path leaves the forward search on the road (u, v) such that u is settled
+    // forward and v is not, or v is the destination. Then v is settled backward, so the
+    // settled cities of either side are enough to find every such road.
+    bool fromForward = forward->nSettled <= backward->nSettled;
+    SearchWorkspace const *ws = fromForward ? forward : backward;
+
+    for (uint64_t i = 0; i < ws->nSettled && paths < 2; i++) {
+        uint64_t x = ws->settled[i];
+
+        if (!fromForward && SearchWorkspace_isSettled(forward, x) && x != dest)
+            continue;
+
+        for (uint64_t e = graph->offsets[x]; e < graph->offsets[x + 1]; e++) {
+            uint64_t y = graph->targets[e];
+            uint64_t u = fromForward ? x : y;
+            uint64_t v = fromForward ? y : x;
+
+            if (!SearchWorkspace_isSettled(forward, u) ||
+                !SearchWorkspace_isSettled(backward, v) || (SearchWorkspace_isSettled(forward, v) && v != dest))
+                continue;
+
+            if (forward->dist[u] + graph->lengths[e] + backward->dist[v] == best) {
+                paths = addPaths(paths, (uint8_t) (forward->paths[u] * backward->paths[v]));
+                *meetFrom = u;
+                *meetTo = v;
+            }
+        }
     }
 
-    UnusedRoute_free(optimalPath);
-    return NULL;
+    return paths;
 }
 
-bool newRoute(Map *map, unsigned routeId, const char *city1, const char *city2) {
-    if (!checkCityName(city1) || !checkCityName(city2))
-        return false;
+/* Finds the unique shortest path searching from both ends at once. Equal
+ * length paths make the route ambiguous whatever their years are, just like in dijkstra,
+ * so it is enough to count the shortest paths. */
+Route *bidirectionalDijkstra(Map *map, City *src, City *destination) {
+    CsrGraph *graph = map->graph;
 
-    City *srcCity = search_hmap(map->nameToCity, (void *) city1);
-    City *destCity = search_hmap(map->nameToCity, (void *) city2);
+    if (!graph->valid && !CsrGraph_rebuild(graph, map->cities, map->nCities))
+        return NULL;
 
-    if (!srcCity || !destCity || strcmp(city1, city2) == 0 || routeId < 1 || routeId > 999 ||
-        map->routes[routeId] != NULL)
-        return false;
+    SearchWorkspace *forward = map->workspace;
+    SearchWorkspace *backward = map->reverseWorkspace;
 
-    Route *shortestPath = dijkstra(map, srcCity, destCity);
+    if (!SearchWorkspace_begin(forward, map->nCities) || !SearchWorkspace_begin(backward, map->nCities))
+        return NULL;
 
-    if (shortestPath == NULL)
+    if (!SearchWorkspace_relax(forward, src->id, 0, 0, INT32_MAX, NULL) ||
+        !SearchWorkspace_relax(backward, destination->id, 0, 0, INT32_MAX, NULL))
+        return NULL;
+
+    forward->paths[src->id] = 1;
+    backward->paths[destination->id] = 1;
+
+    uint64_t best = UINT64_MAX;
+    uint64_t radius[2] = {0, 0};
+    int side = 0;
+
+    while (true) {
+        SearchWorkspace *ws = side == 0 ? forward : backward;
+        uint64_t u = SearchWorkspace_extractMin(ws);
+
+        // The whole component is settled from one side, every shortest path is known
+        if (u == UINT64_MAX)
+            break;
+
+        radius[side] = ws->dist[u];
+        if (!scanRoads(map, ws, NULL, 0, NULL, side == 0 ? backward : forward, u, &best))
+            return NULL;
+
+        // Every city closer than the radius of its side is settled, so when the radii
+        // exceed best, each city of every shortest path is settled from some side
+        if (best != UINT64_MAX && (radius[0] > best || radius[1] > best - radius[0]))
+            break;
+
+        side = 1 - side;
+    }
+
+    uint64_t meetFrom = 0, meetTo = 0;
+
+    if (forward->failed || backward->failed || best == UINT64_MAX ||
+        countMeetingPaths(map, forward, backward, destination->id, best, &meetFrom, &meetTo) != 1)
+        return NULL;
+
+    // Forward parents lead from the meeting road to the source, backward ones to the destination
+    Route *route = Route_get(map, forward, map->cities[meetFrom]);
+
+    for (City *city = map->cities[meetTo]; route != NULL && city != NULL;
+         city = SearchWorkspace_parent(backward, city->id)) {
+        if (!appendByRoad(map, route, city)) {
+            Route_free(route);
+            return NULL;
+        }
+    }
+
+    return route;
+}
+
+bool prepareHierarchy(Map *map) {
+    if (!map->graph->valid && !CsrGraph_rebuild(map->graph, map->cities, map->nCities))
         return false;
 
-    map->routes[routeId] = shortestPath;
+    return ContractionHierarchy_build(map->hierarchy, map->graph);
+}
 
-    return true;
+/* Appends the roads an edge of the hierarchy stands for, unpacking shortcuts recursively */
+static bool appendUnpacked(Map *map, Route *route, uint64_t u, uint64_t v) {
+    uint64_t middle = ContractionHierarchy_middle(map->hierarchy, u, v);
+
+    if (middle == HIERARCHY_NO_MIDDLE)
+        return appendByRoad(map, route, map->cities[v]);
+
+    return appendUnpacked(map, route, u, middle) && appendUnpacked(map, route, middle, v);
+}
+
+static bool appendUpwardPath(Map *map, Route *route, SearchWorkspace *ws, City *city) {
+    City *parent = SearchWorkspace_parent(ws, city->id);
+
+    if (parent == NULL)
+        return true;
+
+    return appendUpwardPath(map, route, ws, parent) && appendUnpacked(map, route, parent->id, city->id);
 }
 
-static inline bool isInRoute(Route *route, City *city) {
-    RouteNode *routeNode = route->routeNodeList->head;
-    while (routeNode != NULL) {
-        if (routeNode->city == city)
-            return true;
-        routeNode = routeNode->next;
+/* Relaxes the upward edges of the settled city u, counting the shortest paths like scanRoads */
+static inline bool scanUpward(Map *map, SearchWorkspace *ws, uint64_t u) {
+    ContractionHierarchy *ch = map->hierarchy;
+    uint64_t distU = ws->dist[u];
+    uint8_t pathsU = ws->paths[u];
+
+    for (uint64_t e = ch->offsets[u]; e < ch->offsets[u + 1]; e++) {
+        uint64_t v = ch->targets[e];
+
+        if (SearchWorkspace_isSettled(ws, v))
+            continue;
+
+        uint64_t distV = distU + ch->lengths[e];
+        uint64_t currentDist = SearchWorkspace_dist(ws, v);
+        uint8_t paths = pathsU * ch->paths[e] < 2 ? pathsU * ch->paths[e] : 2;
+
+        if (distV < currentDist) {
+            if (!SearchWorkspace_relax(ws, v, distV, distV, 0, map->cities[u]))
+                return false;
+            ws->paths[v] = paths;
+        } else if (distV == currentDist) {
+            ws->paths[v] = addPaths(ws->paths[v], paths);
+        }
     }
 
-    return false;
+    return true;
 }
 
-void get_LengthSum_OldestYear(Route *route, uint64_t *lengthSum, int *year) {
-    if (route == NULL)
-        return;
+/* Answers the query with upward searches from both ends in the contraction hierarchy.
+ * Every shortest path is one up-down path whose highest city is settled from both
+ * sides, so the paths are counted there. An outdated hierarchy is rebuilt only after
+ * HIERARCHY_STALE_QUERIES queries were answered by dijkstra in the meantime. */
+Route *hierarchyDijkstra(Map *map, City *src, City *destination) {
+    ContractionHierarchy *ch = map->hierarchy;
+
+    if (!ch->valid) {
+        if (++ch->staleQueries < HIERARCHY_STALE_QUERIES || !prepareHierarchy(map))
+            return dijkstra(map, src, destination, NULL);
+    }
 
-    RouteNode *routeNode = route->routeNodeList->head;
-    uint64_t sum = 0;
-    int oldestYear = 0;
+    SearchWorkspace *forward = map->workspace;
+    SearchWorkspace *backward = map->reverseWorkspace;
 
-    while (routeNode != NULL) {
-        if (oldestYear == 0) {
-            oldestYear = routeNode->age;
-        } else {
-            oldestYear = compareMin(oldestYear, routeNode->age);
+    if (!SearchWorkspace_begin(forward, map->nCities) || !SearchWorkspace_begin(backward, map->nCities))
+        return NULL;
+
+    if (!SearchWorkspace_relax(forward, src->id, 0, 0, 0, NULL) ||
+        !SearchWorkspace_relax(backward, destination->id, 0, 0, 0, NULL))
+        return NULL;
+
+    forward->paths[src->id] = 1;
+    backward->paths[destination->id] = 1;
+
+    uint64_t best = UINT64_MAX;
+    bool done[2] = {false, false};
+    int side = 0;
+
+    // Each side settles every city not farther than the best meeting found so far
+    while (!done[0] || !done[1]) {
+        SearchWorkspace *ws = side == 0 ? forward : backward;
+        SearchWorkspace *other = side == 0 ? backward : forward;
+
+        if (!done[side]) {
+            uint64_t u = SearchWorkspace_extractMin(ws);
+
+            if (u == UINT64_MAX || ws->dist[u] > best) {
+                done[side] = true;
+            } else {
+                if (SearchWorkspace_isLabelled(other, u) && ws->dist[u] + other->dist[u] < best)
+                    best = ws->dist[u] + other->dist[u];
+
+                if (!scanUpward(map, ws, u))
+                    return NULL;
+            }
         }
 
-        sum += routeNode->length;
-        routeNode = routeNode->next;
+        side = 1 - side;
     }
 
-    *lengthSum = sum;
-    *year = oldestYear;
-}
+    if (forward->failed || backward->failed)
+        return NULL;
 
-static inline void markVisitedWithout(Route *route, City *city1, City *city2) {
-    if (route == NULL)
-        return;
+    uint8_t paths = 0;
+    uint64_t meet = 0;
 
-    RouteNode *routeNode = route->routeNodeList->head;
+    for (uint64_t i = 0; i < forward->nSettled && paths < 2; i++) {
+        uint64_t x = forward->settled[i];
 
-    while (routeNode != NULL) {
-        if (routeNode->city != city1 && routeNode->city != city2) {
-            routeNode->city->visited = true;
-            routeNode = routeNode->next;
-        } else {
-            routeNode->city->visited = false;
-            routeNode = routeNode->next;
+        if (SearchWorkspace_isSettled(backward, x) && forward->dist[x] + backward->dist[x] == best) {
+            paths = addPaths(paths, (uint8_t) (forward->paths[x] * backward->paths[x]));
+            meet = x;
         }
     }
-}
 
-static inline void markVisited(Route *route) {
-    if (route == NULL)
-        return;
+    if (best == UINT64_MAX || paths != 1)
+        return NULL;
 
-    RouteNode *routeNode = route->routeNodeList->head;
+    Route *route = Route_create(0);
+    bool built = route != NULL && Route_append(route, src, 0, 0) &&
+                 appendUpwardPath(map, route, forward, map->cities[meet]);
 
-    while (routeNode != NULL) {
-        routeNode->city->visited = true;
-        routeNode = routeNode->next;
+    for (City *city = map->cities[meet]; built && SearchWorkspace_parent(backward, city->id) != NULL;
+         city = SearchWorkspace_parent(backward, city->id))
+        built = appendUnpacked(map, route, city->id, SearchWorkspace_parent(backward, city->id)->id);
+
+    if (!built) {
+        Route_free(route);
+        return NULL;
     }
+
+    return route;
 }
 
-static inline void markUnvisited(Route *route) {
-    if (route == NULL)
-        return;
+/* Creates the route between the cities with the given keys, searching for it in the given way */
+static bool newRouteOfKeys(Map *map, unsigned routeId, const NameKey *city1, const NameKey *city2,
+                           RouteSearch search) {
+    if (!checkCityName(city1) || !checkCityName(city2))
+        return false;
+
+    City *srcCity = search_hmap_key(map->nameToCity, city1);
+    City *destCity = search_hmap_key(map->nameToCity, city2);
 
-    RouteNode *routeNode = route->routeNodeList->head;
+    if (!srcCity || !destCity || sameNames(city1, city2) || routeId < 1 || routeId > 999 ||
+        map->routes[routeId] != NULL)
+        return false;
+
+    Route *shortestPath;
 
-    while (routeNode != NULL) {
-        routeNode->city->visited = false;
-        routeNode = routeNode->next;
+    if (search == SEARCH_HIERARCHY)
+        shortestPath = hierarchyDijkstra(map, srcCity, destCity);
+    else if (search == SEARCH_BIDIRECTIONAL)
+        shortestPath = bidirectionalDijkstra(map, srcCity, destCity);
+    else
+        shortestPath = dijkstra(map, srcCity, destCity, NULL);
+
+    if (shortestPath == NULL)
+        return false;
+
+    if (!addRouteOnMap(map, routeId, shortestPath)) {
+        Route_free(shortestPath);
+        return false;
     }
+
+    return true;
 }
 
-void extendFromEnd(Map *map, unsigned routeId, Route *route, Route *routeFromEnd) {
-    RouteNode *nodeBeforeTail = route->routeNodeList->head;
+static inline RouteSearch defaultSearch(Map *map) {
+    return map->hierarchy->requested ? SEARCH_HIERARCHY : SEARCH_FORWARD;
+}
 
-    while (nodeBeforeTail->next != route->routeNodeList->tail) {
-        nodeBeforeTail = nodeBeforeTail->next;
-    }
+bool newRoute(Map *map, unsigned routeId, const char *city1, const char *city2) {
+    return newRouteWithSearch(map, routeId, city1, city2, defaultSearch(map));
+}
 
-    free(nodeBeforeTail->next);
-    nodeBeforeTail->next = NULL;
-    nodeBeforeTail->next = routeFromEnd->routeNodeList->head;
-    route->routeNodeList->tail = routeFromEnd->routeNodeList->tail;
+bool newRouteWithSearch(Map *map, unsigned routeId, const char *city1, const char *city2, RouteSearch search) {
+    NameKey key1 = Name_key(city1, strlen(city1));
+    NameKey key2 = Name_key(city2, strlen(city2));
 
-    free(routeFromEnd->routeNodeList);
-    free(routeFromEnd);
-    map->routes[routeId] = route;
+    return newRouteOfKeys(map, routeId, &key1, &key2, search);
+}
 
+bool newRouteKeyed(Map *map, unsigned routeId, const NameKey *city1, const NameKey *city2) {
+    return newRouteOfKeys(map, routeId, city1, city2, defaultSearch(map));
 }
 
-void extendFromStart(Map *map, unsigned routeId, Route *route, Route *routeToStart) {
-    RouteNode *nodeBeforeTail = routeToStart->routeNodeList->head;
+bool addRouteOnMap(Map *map, unsigned routeId, Route *route) {
+    route->index = RouteCities_create(route->count);
+
+    if (route->index == NULL)
+        return false;
+
+    for (uint64_t i = route->first; i < route->first + route->count; i++) {
+        uint64_t id = route->cities[i]->id;
 
-    while (nodeBeforeTail->next != routeToStart->routeNodeList->tail) {
-        nodeBeforeTail = nodeBeforeTail->next;
+        // A route passes through every city at most once
+        if (RouteCities_contains(route->index, id) || !RouteCities_insert(route->index, id, i)) {
+            RouteCities_free(route->index);
+            route->index = NULL;
+            return false;
+        }
     }
 
-    free(nodeBeforeTail->next);
-    nodeBeforeTail->next = NULL;
-    nodeBeforeTail->next = route->routeNodeList->head;
-    route->routeNodeList->head = routeToStart->routeNodeList->head;
+    if (!indexRouteRoads(map, routeId, route)) {
+        unindexRouteRoads(map, routeId, route);
+        RouteCities_free(route->index);
+        route->index = NULL;
+        return false;
+    }
 
-    free(routeToStart->routeNodeList);
-    free(routeToStart);
     map->routes[routeId] = route;
+
+    return true;
+}
+
+/* Data shared by both searches of extendRoute */
+typedef struct ExtensionSearch {
+    Map *map;
+    Landmarks const *landmarks;
+    Route const *route;
+    City *extendTo;
+    Route *found[2]; /* Extension from the end of the route and the one to its start */
+    atomic_uint_fast64_t limit; /* Length of the extension found first, UINT64_MAX before */
+} ExtensionSearch;
+
+static void searchExtension(void *context, unsigned worker, uint64_t task) {
+    ExtensionSearch *search = (ExtensionSearch *) context;
+    Map *map = search->map;
+    SearchWorkspace *ws = map->workerSpaces != NULL ? map->workerSpaces[worker] : map->workspace;
+    bool fromEnd = task == 0;
+
+    // Both searches go around the cities of the route, apart from the end they start or finish at.
+    // The one finishing later stops once it can only find a longer extension, which would lose anyway.
+    Route *found = searchRoute(map, ws, search->landmarks, fromEnd ? Route_tail(search->route) : search->extendTo,
+                               fromEnd ? search->extendTo : Route_head(search->route), search->route->index,
+                               &search->limit);
+    search->found[task] = found;
+
+    if (found != NULL)
+        atomic_store(&search->limit, found->length);
 }
 
 bool extendRoute(Map *map, unsigned routeId, const char *city) {
+    NameKey key = Name_key(city, strlen(city));
+
+    return extendRouteKeyed(map, routeId, &key);
+}
+
+bool extendRouteKeyed(Map *map, unsigned routeId, const NameKey *city) {
     if (!checkCityName(city))
         return false;
 
-    City *extendTo = search_hmap(map->nameToCity, (void *) city);
+    City *extendTo = search_hmap_key(map->nameToCity, city);
     if (routeId < 1 || routeId > 999 || map->routes[routeId] == NULL || extendTo == NULL)
         return false;
 
     Route *route = map->routes[routeId];
-    if (isInRoute(route, extendTo))
+    if (RouteCities_contains(route->index, extendTo->id))
         return false;
 
-    RouteNode *routeTail = route->routeNodeList->tail;
-    RouteNode *routeHead = route->routeNodeList->head;
-    markVisited(route);
-    routeTail->city->visited = false;
-    Route *routeFromEnd = dijkstra(map, routeTail->city, extendTo);
-    routeHead->city->visited = false;
-    routeTail->city->visited = true;
-    Route *routeToStart = dijkstra(map, extendTo, routeHead->city);
-    routeHead->city->visited = false;
-    routeTail->city->visited = false;
-    uint64_t fromEndLength = 0, fromStartLength = 0;
-    int fromEndYear = 0, fromStartYear = 0;
-
-    if (routeFromEnd == NULL && routeToStart == NULL) {
-        markUnvisited(route);
+    // Everything the searches could build lazily is built before they start
+    if (!map->graph->valid && !CsrGraph_rebuild(map->graph, map->cities, map->nCities))
         return false;
-    }
 
-    get_LengthSum_OldestYear(routeFromEnd, &fromEndLength, &fromEndYear);
-    get_LengthSum_OldestYear(routeToStart, &fromStartLength, &fromStartYear);
+    ExtensionSearch search;
+    search.map = map;
+    search.landmarks = guidingLandmarks(map);
+    search.route = route;
+    search.extendTo = extendTo;
+    atomic_init(&search.limit, UINT64_MAX);
 
-    if (routeFromEnd != NULL && routeToStart != NULL && fromEndLength == fromStartLength &&
-        fromEndYear == fromStartYear) {
-        UnusedRoute_free(routeToStart);
-        UnusedRoute_free(routeFromEnd);
-        markUnvisited(route);
-        return false;
-    }
+    WorkerPool *workers = concurrentWorkers(map);
 
-    if (routeFromEnd != NULL &&
-        (routeToStart == NULL ||
-         (fromEndLength < fromStartLength || (fromEndLength == fromStartLength && fromEndYear > fromStartYear)))) {
-        extendFromEnd(map, routeId, route, routeFromEnd);
-        UnusedRoute_free(routeToStart);
-    } else if (routeToStart != NULL &&
-               (routeFromEnd == NULL || (fromStartLength < fromEndLength ||
-                                         (fromEndLength == fromStartLength && fromStartYear > fromEndYear)))) {
-        extendFromStart(map, routeId, route, routeToStart);
-        UnusedRoute_free(routeFromEnd);
+    if (workers != NULL) {
+        WorkerPool_run(workers, searchExtension, &search, 2);
+    } else {
+        searchExtension(&search, 0, 0);
+        searchExtension(&search, 0, 1);
     }
 
-    markUnvisited(route);
-    return true;
-}
+    Route *routeFromEnd = search.found[0];
+    Route *routeToStart = search.found[1];
 
-void removeRoadInAdjList(City *city1, City *city2) {
-    Road *fakeHead = Road_create(NULL, 0, 0);
-    fakeHead->nextRoadOfCity = (Road *) city1->roadsList->head;
-    Road *road = fakeHead;
+    if (routeFromEnd == NULL && routeToStart == NULL)
+        return false;
 
-    while (road->nextRoadOfCity != NULL) {
-        if (road->nextRoadOfCity->adjCity == city2) {
-            Road *next = road->nextRoadOfCity->nextRoadOfCity;
-            free(road->nextRoadOfCity);
-            road->nextRoadOfCity = NULL;
-            road->nextRoadOfCity = next;
-            city1->roadsList->head = fakeHead->nextRoadOfCity;
+    // Lengths and oldest years of the candidates come with them from the searches
+    bool fromEnd = routeToStart == NULL;
 
-            if (city1->roadsList->head == NULL)
-                city1->roadsList->tail = NULL;
-            else if (road->nextRoadOfCity == NULL)
-                city1->roadsList->tail = road;
+    if (routeFromEnd != NULL && routeToStart != NULL) {
+        int fromEndYear = Route_oldestYear(routeFromEnd);
+        int fromStartYear = Route_oldestYear(routeToStart);
 
-            free(fakeHead);
-            return;
+        if (routeFromEnd->length == routeToStart->length && fromEndYear == fromStartYear) {
+            Route_free(routeToStart);
+            Route_free(routeFromEnd);
+            return false;
         }
 
-        road = road->nextRoadOfCity;
+        fromEnd = routeFromEnd->length < routeToStart->length ||
+                  (routeFromEnd->length == routeToStart->length && fromEndYear > fromStartYear);
     }
 
-    free(fakeHead);
-}
+    Route *extension = fromEnd ? routeFromEnd : routeToStart;
+    bool extended = indexRouteRoads(map, routeId, extension) &&
+                    (fromEnd ? Route_appendRoute(route, extension) : Route_prependRoute(route, extension));
+
+    if (!extended)
+        unindexRouteRoads(map, routeId, extension);
 
-bool isRoadInRoute(Route *route, City *city1, City *city2) {
-    RouteNode *routeNode = route->routeNodeList->head;
+    Route_free(routeToStart);
+    Route_free(routeFromEnd);
+
+    return extended;
+}
 
-    while (routeNode != NULL && routeNode->next != NULL) {
-        if (routeNode->city == city1 && routeNode->next->city == city2)
-            return true;
-        else if (routeNode->city == city2 && routeNode->next->city == city1)
-            return true;
+/* Unlinks the road from the roads of the city and from the edge index, without freeing it.
+ * Gives the road before it on the list, NULL if it was the first one. */
+static Road *detachRoad(Map *map, City *city, Road *road) {
+    Road *prev = NULL;
+    Road *current = (Road *) city->roadsList->head;
 
-        routeNode = routeNode->next;
+    while (current != road) {
+        prev = current;
+        current = current->nextRoadOfCity;
     }
 
-    return false;
-}
+    if (prev == NULL)
+        city->roadsList->head = road->nextRoadOfCity;
+    else
+        prev->nextRoadOfCity = road->nextRoadOfCity;
 
-bool dijkstraDirection(Route *route, City *city1, City *city2) {
-    RouteNode *current = (RouteNode *) route->routeNodeList->head;
+    if (city->roadsList->tail == road)
+        city->roadsList->tail = prev;
 
-    while (current != NULL && current->next != NULL) {
-        if (current->city == city1 && current->next->city == city2)
-            return false;
-        else if (current->city == city2 && current->next->city == city1) {
-            return true;
-        }
+    EdgeIndex_remove(map->roads, city->id, road->adjCity->id);
 
-        current = current->next;
+    return prev;
+}
+
+/* Links a detached road back behind prev, so the order of the roads of the city is kept */
+static void attachRoad(Map *map, City *city, Road *road, Road *prev) {
+    if (prev == NULL) {
+        road->nextRoadOfCity = (Road *) city->roadsList->head;
+        city->roadsList->head = road;
+    } else {
+        road->nextRoadOfCity = prev->nextRoadOfCity;
+        prev->nextRoadOfCity = road;
     }
 
-    return false;
+    if (road->nextRoadOfCity == NULL)
+        city->roadsList->tail = road;
+
+    // The slots of the road were freed when it was detached, so the index does not grow
+    EdgeIndex_insert(map->roads, city->id, road->adjCity->id, road);
 }
 
-bool checkRemoveInRoutes(Map *map, City *city1, City *city2) {
-    for (int i = 1; i < ROUTES_SIZE; ++i) {
-        if (map->routes[i] != NULL && isRoadInRoute(map->routes[i], city1, city2)) {
-            markVisitedWithout(map->routes[i], city1, city2);
-            bool oppDir = dijkstraDirection(map->routes[i], city1, city2);
+/* Replacement of a removed road on one route */
+typedef struct Detour {
+    unsigned routeId;
+    City *from; /* City the removed road leaves from on the route */
+    Route *path;
+} Detour;
+
+/* Data shared by the detour searches of one removed road */
+typedef struct DetourSearch {
+    Map *map;
+    Landmarks const *landmarks;
+    Detour *detours;
+    atomic_bool failed; /* Set when a route cannot be rerouted, the remaining searches are skipped */
+} DetourSearch;
+
+static void searchDetour(void *context, unsigned worker, uint64_t task) {
+    DetourSearch *search = (DetourSearch *) context;
+    Detour *detour = &search->detours[task];
+
+    if (atomic_load(&search->failed))
+        return;
 
-            if (oppDir == true) {
-                City *temp = city1;
-                city1 = city2;
-                city2 = temp;
-            }
+    Map *map = search->map;
+    Route *route = map->routes[detour->routeId];
+    uint64_t position = RouteCities_find(route->index, detour->from->id);
+    SearchWorkspace *ws = map->workerSpaces != NULL ? map->workerSpaces[worker] : map->workspace;
 
-            Route *newRoute = dijkstra(map, city1, city2);
+    // Search in the direction of the route, from the city the removed road leaves
+    detour->path = searchRoute(map, ws, search->landmarks, detour->from, route->cities[position + 1],
+                               route->index, NULL);
 
-            if (newRoute == NULL) {
-                markUnvisited(map->routes[i]);
-                return false;
-            }
+    if (detour->path == NULL)
+        atomic_store(&search->failed, true);
+}
 
-            markUnvisited(map->routes[i]);
-            UnusedRoute_free(newRoute);
-        }
+/* Searches for a detour of every route going along the detached road and prepares the routes for it.
+ * The searches only read the graph, so they run on the workers when there are a few of them.
+ * Gives false, with nothing prepared, if some route cannot be rerouted or memory allocation failed. */
+static bool planDetours(Map *map, RouteUse *uses, Detour **plan, uint64_t *count) {
+    // With no route to reroute the graph is left to be rebuilt by the next search
+    if (uses == NULL) {
+        *plan = NULL;
+        *count = 0;
+        return true;
     }
 
-    return true;
-}
+    uint64_t n = 0;
+    for (RouteUse *use = uses; use != NULL; use = use->next)
+        n++;
+
+    // Everything the searches could build lazily is built before they start
+    if (!map->graph->valid && !CsrGraph_rebuild(map->graph, map->cities, map->nCities))
+        return false;
+
+    Detour *detours = (Detour *) malloc(n * sizeof(Detour));
+    if (detours == NULL)
+        return false;
+
+    uint64_t i = 0;
+    for (RouteUse *use = uses; use != NULL; use = use->next, i++)
+        detours[i] = (Detour) {use->routeId, use->from, NULL};
+
+    DetourSearch search;
+    search.map = map;
+    search.landmarks = guidingLandmarks(map);
+    search.detours = detours;
+    atomic_init(&search.failed, false);
 
-void removeInRoute(Map *map, unsigned routeId, Route *route, City *city1, City *city2) {
-    markVisitedWithout(route, city1, city2);
-    bool oppDir = dijkstraDirection(route, city1, city2);
+    WorkerPool *workers = n > 1 ? concurrentWorkers(map) : NULL;
 
-    if (oppDir == true) {
-        City *temp = city1;
-        city1 = city2;
-        city2 = temp;
+    if (workers != NULL) {
+        WorkerPool_run(workers, searchDetour, &search, n);
+    } else {
+        for (i = 0; i < n; i++)
+            searchDetour(&search, 0, i);
     }
 
-    Route *newRoute = dijkstra(map, city1, city2);
-    markUnvisited(newRoute);
+    // Index the new roads and make room in the routes in the order of ids, so the commit cannot fail
+    uint64_t planned = 0;
+    while (planned < n) {
+        Detour *detour = &detours[planned];
+        Route *route = map->routes[detour->routeId];
 
-    if (newRoute == NULL) {
-        markUnvisited(route);
-        return;
+        if (detour->path == NULL || !Route_reserve(route, detour->path) ||
+            !indexRouteRoads(map, detour->routeId, detour->path)) {
+            if (detour->path != NULL)
+                unindexRouteRoads(map, detour->routeId, detour->path);
+
+            break;
+        }
+
+        planned++;
     }
 
-    RouteNode *fakeNode = RouteNode_create(NULL, 0, 0);
-    fakeNode->next = (RouteNode *) route->routeNodeList->head;
-    RouteNode *current = fakeNode;
-
-    while (current->next->next != NULL) {
-        if ((current->next->city == city1 && current->next->next->city == city2) ||
-            (current->next->city == city2 && current->next->next->city == city1)) {
-            RouteNode *next = current->next->next;
-            int builtYear = current->age;
-            uint64_t length = current->length;
-            free(current->next);
-            current->next = NULL;
-            current->next = (RouteNode *) newRoute->routeNodeList->head;
-            current->age = builtYear;
-            current->length = length;
-            RouteNode *newRouteTail = (RouteNode *) newRoute->routeNodeList->tail;
-            newRouteTail->next = next->next;
-            newRouteTail->length = next->length;
-            newRouteTail->age = next->age;
-            free(next);
-            route->routeNodeList->head = fakeNode->next;
-
-            if (newRouteTail->next == NULL)
-                route->routeNodeList->tail = newRouteTail;
-
-            free(newRoute->routeNodeList);
-            free(newRoute);
-            free(fakeNode);
-            map->routes[routeId] = route;
-            markUnvisited(route);
-            return;
+    if (planned < n) {
+        for (i = 0; i < n; i++) {
+            if (i < planned)
+                unindexRouteRoads(map, detours[i].routeId, detours[i].path);
+
+            Route_free(detours[i].path);
         }
 
-        current = current->next;
+        free(detours);
+        return false;
     }
 
-    markUnvisited(route);
-    UnusedRoute_free(newRoute);
-    free(fakeNode);
+    *plan = detours;
+    *count = n;
+
+    return true;
 }
 
 bool removeRoad(Map *map, const char *city1, const char *city2) {
+    NameKey key1 = Name_key(city1, strlen(city1));
+    NameKey key2 = Name_key(city2, strlen(city2));
+
+    return removeRoadKeyed(map, &key1, &key2);
+}
+
+bool removeRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2) {
     if (!checkCityName(city1) || !checkCityName(city2))
         return false;
 
-    City *firstCity = (City *) search_hmap(map->nameToCity, (void *) city1);
-    City *secondCity = (City *) search_hmap(map->nameToCity, (void *) city2);
-    Road *road1 = areConnected(firstCity, secondCity);
-    Road *road2 = areConnected(secondCity, firstCity);
+    City *firstCity = (City *) search_hmap_key(map->nameToCity, city1);
+    City *secondCity = (City *) search_hmap_key(map->nameToCity, city2);
+    Road *road1 = areConnected(map->roads, firstCity, secondCity);
+    Road *road2 = areConnected(map->roads, secondCity, firstCity);
 
-    if (!firstCity || !secondCity || !road1 || !road2 || strcmp(city1, city2) == 0)
+    if (!firstCity || !secondCity || !road1 || !road2 || sameNames(city1, city2))
         return false;
 
-    uint64_t length = road1->length;
-    int year = road1->builtYear;
-    removeRoadInAdjList(firstCity, secondCity);
-    removeRoadInAdjList(secondCity, firstCity);
+    RouteUse *uses = indexedRoad(map, firstCity, secondCity)->routeUses;
+    Detour *plan;
+    uint64_t count;
+
+    // The roads are only detached while the detours are planned, so a failure puts them back as they were
+    Road *prev1 = detachRoad(map, firstCity, road1);
+    Road *prev2 = detachRoad(map, secondCity, road2);
+    Landmarks_removeRoad(map->landmarks, firstCity->id, secondCity->id, road1->length);
+    CsrGraph_invalidate(map->graph);
+    ContractionHierarchy_invalidate(map->hierarchy);
+
+    if (!planDetours(map, uses, &plan, &count)) {
+        attachRoad(map, secondCity, road2, prev2);
+        attachRoad(map, firstCity, road1, prev1);
+        CsrGraph_invalidate(map->graph);
+        Landmarks_addRoad(map->landmarks, map->cities, map->nCities, firstCity, secondCity, road1->length);
 
-    if (!checkRemoveInRoutes(map, firstCity, secondCity)) {
-        addRoad(map, firstCity->cityName, secondCity->cityName, length, year);
         return false;
     }
 
-    for (int i = 1; i < ROUTES_SIZE; ++i) {
-        if (map->routes[i] != NULL && isRoadInRoute(map->routes[i], firstCity, secondCity)) {
-            removeInRoute(map, i, map->routes[i], firstCity, secondCity);
-        }
+    // Only the routes going along the road are rerouted, in the increasing order of ids
+    for (uint64_t i = 0; i < count; i++) {
+        Route *route = map->routes[plan[i].routeId];
+
+        // Positions are looked up only now, as making room may have moved the cities
+        Route_splice(route, RouteCities_find(route->index, plan[i].from->id), plan[i].path);
+        Route_free(plan[i].path);
+    }
+
+    free(plan);
+
+    while (uses != NULL) {
+        RouteUse *next = uses->next;
+        Pool_release(&map->pools.routeUses, uses);
+        uses = next;
     }
 
+    Pool_release(&map->pools.roads, road1);
+    Pool_release(&map->pools.roads, road2);
+
     return true;
 }
 
@@ -714,54 +1177,36 @@ bool removeRoute(Map *map, unsigned routeId) {
     if (routeId < 1 || routeId > 999 || map->routes[routeId] == NULL)
         return false;
 
-    UnusedRoute_free(map->routes[routeId]);
+    Route *route = map->routes[routeId];
+    unindexRouteRoads(map, routeId, route);
+    Route_free(route);
     map->routes[routeId] = NULL;
 
     return true;
 }
 
-char const *getRouteDescription(Map *map, unsigned routeId) {
+char const *describeRoute(Map *map, unsigned routeId, size_t *length) {
     if (routeId < 1 || routeId > 999 || map->routes[routeId] == NULL) {
-        char *c = malloc(1);
-
-        if (c == NULL)
-            return NULL;
-
-        c[0] = '\0';
-        return c;
+        *length = 0;
+        return "";
     }
 
-    Route *route = map->routes[routeId];
-    RouteNode *routeNode = route->routeNodeList->head;
-    size_t totalSize = BUFF_SIZE;
-    char *b = (char *) malloc(totalSize * sizeof(char));
-
-    if (b == NULL)
-        return NULL;
-
-    if (routeNode == NULL) {
-        free(b);
-        char *c = malloc(1);
-        c[0] = '\0';
-        return c;
-    }
+    return Route_description(map->routes[routeId], routeId, length);
+}
 
-    sprintf(b, "%u", routeId);
-    size_t b_size = strlen(b);
+char const *getRouteDescription(Map *map, unsigned routeId) {
+    size_t length;
+    const char *description = describeRoute(map, routeId, &length);
 
-    while (routeNode->next != NULL) {
-        sprintf(b_size + b, ";%s;%u;%d", routeNode->city->cityName, routeNode->length, routeNode->age);
-        b_size = strlen(b);
+    if (description == NULL)
+        return NULL;
 
-        if (b_size > (totalSize * 0.75)) {
-            totalSize = 2 * totalSize;
-            b = (char *) realloc(b, totalSize * sizeof(char));
-        }
+    char *copy = (char *) malloc(length + 1);
 
-        routeNode = routeNode->next;
-    }
+    if (copy == NULL)
+        return NULL;
 
-    sprintf(b_size + b, ";%s", routeNode->city->cityName);
+    memcpy(copy, description, length + 1);
 
-    return b;
+    return copy;
 }
\ No newline at end of file
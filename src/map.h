@@ -12,9 +12,24 @@
 #include <stdbool.h>
 #include "CityRoad.h"
 #include "HashMap.h"
+#include "CsrGraph.h"
+#include "EdgeIndex.h"
+#include "SearchWorkspace.h"
+#include "Landmarks.h"
+#include "ContractionHierarchy.h"
+#include "WorkerPool.h"
 
 #define ROUTES_SIZE 1000
 
+/**
+ * Sposób wyszukiwania najkrótszej ścieżki przy tworzeniu drogi krajowej.
+ */
+typedef enum RouteSearch {
+    SEARCH_FORWARD, /**< Algorytm Dijkstry prowadzony od miasta początkowego. */
+    SEARCH_BIDIRECTIONAL, /**< Algorytm Dijkstry prowadzony jednocześnie z obu końców drogi. */
+    SEARCH_HIERARCHY /**< Wyszukiwanie w hierarchii skrótów przygotowanej przez @ref prepareHierarchy. */
+} RouteSearch;
+
 /**
  * Struktura przechowująca mapę dróg krajowych.
  */
@@ -24,6 +39,16 @@ typedef struct Map {
     City **cities;
     Route *routes[ROUTES_SIZE];
     hmap *nameToCity;
+    NameArena *names;
+    CsrGraph *graph;
+    EdgeIndex *roads;
+    SearchWorkspace *workspace;
+    SearchWorkspace *reverseWorkspace;
+    Landmarks *landmarks;
+    ContractionHierarchy *hierarchy;
+    WorkerPool *workers;
+    SearchWorkspace **workerSpaces;
+    ObjectPools pools;
 } Map;
 
 /** @brief Tworzy nową strukturę.
@@ -57,6 +82,20 @@ void deleteMap(Map *map);
 bool addRoad(Map *map, const char *city1, const char *city2,
              unsigned length, int builtYear);
 
+/** @brief Dodaje do mapy odcinek drogi między miastami o podanych kluczach.
+ * Działa tak samo jak @ref addRoad, ale długości i hasze nazw miast są
+ * wyznaczone wcześniej, np. przez wątek czytający polecenia.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na klucz nazwy miasta;
+ * @param[in] city2      – wskaźnik na klucz nazwy miasta;
+ * @param[in] length     – długość w km odcinka drogi;
+ * @param[in] builtYear  – rok budowy odcinka drogi.
+ * @return Wartość @p true, jeśli odcinek drogi został dodany.
+ * Wartość @p false w tych samych przypadkach co @ref addRoad.
+ */
+bool addRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2,
+                  unsigned length, int builtYear);
+
 /** @brief Modyfikuje rok ostatniego remontu odcinka drogi.
  * Dla odcinka drogi między dwoma miastami zmienia rok jego ostatniego remontu
  * lub ustawia ten rok, jeśli odcinek nie był jeszcze remontowany.
@@ -72,6 +111,18 @@ bool addRoad(Map *map, const char *city1, const char *city2,
  */
 bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear);
 
+/** @brief Modyfikuje rok ostatniego remontu odcinka drogi między miastami o podanych kluczach.
+ * Działa tak samo jak @ref repairRoad, ale długości i hasze nazw miast są
+ * wyznaczone wcześniej.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na klucz nazwy miasta;
+ * @param[in] city2      – wskaźnik na klucz nazwy miasta;
+ * @param[in] repairYear – rok ostatniego remontu odcinka drogi.
+ * @return Wartość @p true, jeśli modyfikacja się powiodła.
+ * Wartość @p false w tych samych przypadkach co @ref repairRoad.
+ */
+bool repairRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2, int repairYear);
+
 /** @brief Łączy dwa różne miasta drogą krajową.
  * Tworzy drogę krajową pomiędzy dwoma miastami i nadaje jej podany numer.
  * Wśród istniejących odcinków dróg wyszukuje najkrótszą drogę. Jeśli jest
@@ -92,6 +143,94 @@ bool repairRoad(Map *map, const char *city1, const char *city2, int repairYear);
 bool newRoute(Map *map, unsigned routeId,
               const char *city1, const char *city2);
 
+/** @brief Łączy drogą krajową dwa miasta o podanych kluczach.
+ * Działa tak samo jak @ref newRoute, ale długości i hasze nazw miast są
+ * wyznaczone wcześniej.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] city1      – wskaźnik na klucz nazwy miasta;
+ * @param[in] city2      – wskaźnik na klucz nazwy miasta.
+ * @return Wartość @p true, jeśli droga krajowa została utworzona.
+ * Wartość @p false w tych samych przypadkach co @ref newRoute.
+ */
+bool newRouteKeyed(Map *map, unsigned routeId,
+                   const NameKey *city1, const NameKey *city2);
+
+/** @brief Łączy dwa różne miasta drogą krajową, wybranym sposobem wyszukiwania.
+ * Działa tak samo jak @ref newRoute, ale pozwala wybrać dla pojedynczego
+ * zapytania algorytm wyznaczający najkrótszą ścieżkę. Oba algorytmy dają
+ * ten sam wynik.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] city1      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] city2      – wskaźnik na napis reprezentujący nazwę miasta;
+ * @param[in] search     – sposób wyszukiwania najkrótszej ścieżki.
+ * @return Wartość @p true, jeśli droga krajowa została utworzona.
+ * Wartość @p false w tych samych przypadkach co @ref newRoute.
+ */
+bool newRouteWithSearch(Map *map, unsigned routeId,
+                        const char *city1, const char *city2, RouteSearch search);
+
+/** @brief Zapisuje gotową drogę krajową na mapie pod podanym numerem.
+ * Rejestruje miasta drogi krajowej i jej odcinki dróg w indeksach mapy,
+ * z których korzystają funkcje @ref extendRoute, @ref repairRoad
+ * i @ref removeRoad. Numer drogi krajowej musi być wolny.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] route      – wskaźnik na drogę krajową, której kolejne miasta
+ *                         są połączone odcinkami dróg.
+ * @return Wartość @p true, jeśli droga krajowa została zapisana.
+ * Wartość @p false, jeśli droga krajowa przechodzi przez któreś miasto więcej
+ * niż raz lub nie udało się zaalokować pamięci. Wtedy mapa się nie zmienia,
+ * a drogę krajową zwalnia wywołujący.
+ */
+bool addRouteOnMap(Map *map, unsigned routeId, Route *route);
+
+/** @brief Przygotowuje punkty orientacyjne przyspieszające wyznaczanie dróg.
+ * Wybiera @p count miast i wyznacza odległości wszystkich miast od nich.
+ * Z nierówności trójkąta dają one dolne ograniczenia odległości, którymi
+ * kierowane są wyszukiwania funkcji @ref newRoute, @ref extendRoute
+ * i @ref removeRoad. Dodanie odcinka drogi aktualizuje odległości na bieżąco.
+ * Usunięcie odcinka drogi leżącego na najkrótszej ścieżce od punktu
+ * orientacyjnego unieważnia je, a są one wyznaczane ponownie dopiero po
+ * @p count wyszukiwaniach. Wyniki funkcji nie zależą od punktów orientacyjnych.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] count      – liczba punktów orientacyjnych, 0 je wyłącza.
+ * @return Wartość @p true, jeśli punkty orientacyjne zostały przygotowane.
+ * Wartość @p false, jeśli nie udało się zaalokować pamięci.
+ */
+bool prepareLandmarks(Map *map, unsigned count);
+
+/** @brief Przygotowuje hierarchię skrótów przyspieszającą tworzenie dróg krajowych.
+ * Kolejno usuwa z grafu wszystkie miasta, zastępując najkrótsze ścieżki przez
+ * usuwane miasto skrótami. Od tej chwili @ref newRoute wyszukuje drogi
+ * w hierarchii, odwiedzając tylko niewielką część miast. Dodanie lub usunięcie
+ * odcinka drogi unieważnia hierarchię, a zapytania są obsługiwane zwykłym
+ * algorytmem Dijkstry, dopóki hierarchia nie zostanie zbudowana ponownie po
+ * odpowiednio wielu zapytaniach. Remont odcinka drogi nie zmienia długości,
+ * więc nie unieważnia hierarchii. Wyniki funkcji nie zależą od hierarchii.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg.
+ * @return Wartość @p true, jeśli hierarchia została zbudowana.
+ * Wartość @p false, jeśli nie udało się zaalokować pamięci.
+ */
+bool prepareHierarchy(Map *map);
+
+/** @brief Przygotowuje wątki wyszukujące objazdy i przedłużenia dróg krajowych.
+ * Objazdy dróg krajowych przebiegających przez usuwany odcinek są wyszukiwane
+ * równolegle przez @p count wątków, a następnie wprowadzane w kolejności
+ * numerów dróg, więc wynik nie zależy od liczby wątków. Przy przedłużaniu
+ * drogi krajowej oba jej możliwe przedłużenia, od początku i od końca, są
+ * wyszukiwane równolegle przez te same wątki. Bez wywołania tej funkcji
+ * wątki są tworzone, po jednym na procesor, przy pierwszym przedłużeniu
+ * drogi krajowej lub pierwszym usunięciu odcinka drogi, przez który
+ * przebiega kilka dróg krajowych, i używane przez obie operacje później.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] count      – liczba wątków, 1 wyszukuje w wątku wywołującym.
+ * @return Wartość @p true, jeśli wątki zostały przygotowane.
+ * Wartość @p false, jeśli nie udało się zaalokować pamięci lub utworzyć wątku.
+ */
+bool prepareWorkers(Map *map, unsigned count);
+
 /** @brief Wydłuża drogę krajową do podanego miasta.
  * Dodaje do drogi krajowej nowe odcinki dróg do podanego miasta w taki sposób,
  * aby nowy fragment drogi krajowej był najkrótszy. Jeśli jest więcej niż jeden
@@ -111,6 +250,17 @@ bool newRoute(Map *map, unsigned routeId,
  */
 bool extendRoute(Map *map, unsigned routeId, const char *city);
 
+/** @brief Wydłuża drogę krajową do miasta o podanym kluczu.
+ * Działa tak samo jak @ref extendRoute, ale długość i hasz nazwy miasta są
+ * wyznaczone wcześniej.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[in] city       – wskaźnik na klucz nazwy miasta.
+ * @return Wartość @p true, jeśli droga krajowa została wydłużona.
+ * Wartość @p false w tych samych przypadkach co @ref extendRoute.
+ */
+bool extendRouteKeyed(Map *map, unsigned routeId, const NameKey *city);
+
 /** @brief Usuwa odcinek drogi między dwoma różnymi miastami.
  * Usuwa odcinek drogi między dwoma miastami. Jeśli usunięcie tego odcinka drogi
  * powoduje przerwanie ciągu jakiejś drogi krajowej, to uzupełnia ją
@@ -130,6 +280,17 @@ bool extendRoute(Map *map, unsigned routeId, const char *city);
  */
 bool removeRoad(Map *map, const char *city1, const char *city2);
 
+/** @brief Usuwa odcinek drogi między miastami o podanych kluczach.
+ * Działa tak samo jak @ref removeRoad, ale długości i hasze nazw miast są
+ * wyznaczone wcześniej.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] city1      – wskaźnik na klucz nazwy miasta;
+ * @param[in] city2      – wskaźnik na klucz nazwy miasta.
+ * @return Wartość @p true, jeśli odcinek drogi został usunięty.
+ * Wartość @p false w tych samych przypadkach co @ref removeRoad.
+ */
+bool removeRoadKeyed(Map *map, const NameKey *city1, const NameKey *city2);
+
 /** @brief Usuwa z mapy dróg drogę krajową o podanym numerze.
  * Jeśli taka istnieje, a w przeciwnym przypadku,
  * tzn. gdy podana droga krajowa nie istnieje lub podany numer jest niepoprawny,
@@ -158,4 +319,16 @@ bool removeRoute(Map *map, unsigned routeId);
  */
 char const *getRouteDescription(Map *map, unsigned routeId);
 
+/** @brief Udostępnia informacje o drodze krajowej bez ich kopiowania.
+ * Zwraca ten sam napis co @ref getRouteDescription, ale przechowywany w mapie.
+ * Napis jest budowany raz i pamiętany, dopóki droga krajowa się nie zmieni,
+ * w tym przez remont któregoś z jej odcinków. Napis jest ważny do następnej
+ * zmiany mapy i nie wolno go zwalniać.
+ * @param[in,out] map    – wskaźnik na strukturę przechowującą mapę dróg;
+ * @param[in] routeId    – numer drogi krajowej;
+ * @param[out] length    – długość napisu.
+ * @return Wskaźnik na napis lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+char const *describeRoute(Map *map, unsigned routeId, size_t *length);
+
 #endif /* __MAP_H__ */
\ No newline at end of file
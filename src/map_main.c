@@ -13,6 +13,10 @@ int main() {
     if (map == NULL)
         exit(1);
 
-    execCommand(map);
+    // Parsing ahead of the commands pays off only if another processor can do it
+    if (WorkerPool_defaultWorkers() > 1)
+        execCommandPipelined(map);
+    else
+        execCommand(map);
     deleteMap(map);
 }
\ No newline at end of file